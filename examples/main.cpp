@@ -3,10 +3,23 @@
 #include <fstream>
 #include <htk/chronograph.h>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <numeric>
 #include <random>
+#include <string>
 #include <thread>
 
 #include <htk/algorithm.h>
+#include <htk/bitvector.h>
+#include <htk/concurrent_vector.h>
+#include <htk/huge_page_allocator.h>
+#include <htk/mapped_vector.h>
+#include <htk/radix_sort.h>
+#include <htk/search_index.h>
+#include <htk/small_vector.h>
+#include <htk/soa_vector.h>
+#include <htk/stable_vector.h>
 #include <htk/vector.h>
 #include <vector>
 
@@ -31,10 +44,17 @@ struct move_only
     int value;
 };
 
+// all move_only holds is an int, so its bytes can be moved as they are.
+template <>
+struct htk::is_trivially_relocatable<move_only> : htk::true_type
+{
+};
+
 template <typename T, typename VectorT>
 VectorT random_numeric_vector(size_t size, T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max())
 {
     VectorT v;
+    v.reserve(size);
 
     std::uniform_int_distribution<T> distribution(min, max);
 
@@ -161,6 +181,110 @@ void measure_vector_int_emplace(session &s)
     }
 }
 
+// the vector is built and torn down inside the lap, so the allocation is
+// part of what's measured.
+void measure_small_vector_int_emplace(session &s)
+{
+    {
+        benchmark(s, "vector<int> emplace 4", [](session_run &r) {
+            measure(r, []() {
+                std::vector<int> v;
+                for (int i = 0; i < 4; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::vector<int> emplace 4", [](session_run &r) {
+            measure(r, []() {
+                htk::vector<int> v;
+                for (int i = 0; i < 4; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::small_vector<int, 16> emplace 4", [](session_run &r) {
+            measure(r, []() {
+                htk::small_vector<int, 16> v;
+                for (int i = 0; i < 4; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+
+    {
+        benchmark(s, "vector<int> emplace 8", [](session_run &r) {
+            measure(r, []() {
+                std::vector<int> v;
+                for (int i = 0; i < 8; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::vector<int> emplace 8", [](session_run &r) {
+            measure(r, []() {
+                htk::vector<int> v;
+                for (int i = 0; i < 8; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::small_vector<int, 16> emplace 8", [](session_run &r) {
+            measure(r, []() {
+                htk::small_vector<int, 16> v;
+                for (int i = 0; i < 8; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+
+    {
+        benchmark(s, "vector<int> emplace 16", [](session_run &r) {
+            measure(r, []() {
+                std::vector<int> v;
+                for (int i = 0; i < 16; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::vector<int> emplace 16", [](session_run &r) {
+            measure(r, []() {
+                htk::vector<int> v;
+                for (int i = 0; i < 16; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+    {
+
+        benchmark(s, "htk::small_vector<int, 16> emplace 16", [](session_run &r) {
+            measure(r, []() {
+                htk::small_vector<int, 16> v;
+                for (int i = 0; i < 16; ++i)
+                    v.emplace_back(10);
+                do_not_optimize(v.back());
+            });
+        });
+    }
+}
+
 void measure_vector_move_only_emplace(session &s)
 {
     {
@@ -288,6 +412,59 @@ void measure_vector_int_insert_end(session &s)
     }
 }
 
+void measure_vector_int_append(session &s)
+{
+    {
+        benchmark(s, "vector<int> append 1000-1000", [](session_run &r) {
+            std::vector<int> v2 = random_numeric_vector<int, std::vector<int>>(1000);
+            measure(r, [&v2]() {
+                std::vector<int> v;
+                for (int i = 0; i < 1000; ++i)
+                    v.insert(v.end(), v2.begin(), v2.end());
+                do_not_optimize(v.back());
+            });
+        }, { 10, 100, 1000 });
+    }
+
+    {
+        benchmark(s, "htk::vector<int> append_range 1000-1000", [](session_run &r) {
+            auto v2 = random_numeric_vector<int, htk::vector<int>>(1000);
+            measure(r, [&v2]() {
+                htk::vector<int> v;
+                for (int i = 0; i < 1000; ++i)
+                    v.append_range(v2);
+                do_not_optimize(v.back());
+            });
+        }, { 10, 100, 1000 });
+    }
+
+    {
+        benchmark(s, "vector<int> append list 1000-1000", [](session_run &r) {
+            auto v2 = random_numeric_vector<int, std::vector<int>>(1000);
+            std::list<int> l(v2.begin(), v2.end());
+            measure(r, [&l]() {
+                std::vector<int> v;
+                for (int i = 0; i < 1000; ++i)
+                    v.insert(v.end(), l.begin(), l.end());
+                do_not_optimize(v.back());
+            });
+        }, { 10, 100, 1000 });
+    }
+
+    {
+        benchmark(s, "htk::vector<int> append_range list 1000-1000", [](session_run &r) {
+            auto v2 = random_numeric_vector<int, std::vector<int>>(1000);
+            std::list<int> l(v2.begin(), v2.end());
+            measure(r, [&l]() {
+                htk::vector<int> v;
+                for (int i = 0; i < 1000; ++i)
+                    v.append_range(l);
+                do_not_optimize(v.back());
+            });
+        }, { 10, 100, 1000 });
+    }
+}
+
 void measure_vector_int_insert_begin(session &s)
 {
     {
@@ -338,6 +515,571 @@ void measure_vector_int_insert_mid(session &s)
     }
 }
 
+// sizing a buffer that's about to be overwritten; the vector is made and
+// freed inside the lap.
+void measure_vector_resize(session &s)
+{
+    benchmark(s, "vector<char> resize", { 1000, 100000, 10000000 }, [](session_run &r, int size) {
+        measure(r, [size]() {
+            std::vector<char> v;
+            v.resize(size);
+            do_not_optimize(v.data());
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::vector<char> resize", { 1000, 100000, 10000000 }, [](session_run &r, int size) {
+        measure(r, [size]() {
+            htk::vector<char> v;
+            v.resize(size);
+            do_not_optimize(v.data());
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::vector<char> resize_default_init", { 1000, 100000, 10000000 }, [](session_run &r, int size) {
+        measure(r, [size]() {
+            htk::vector<char> v;
+            v.resize_default_init(size);
+            do_not_optimize(v.data());
+        });
+    }, { 10, 100 });
+}
+
+void measure_vector_int_find(session &s)
+{
+    benchmark(s, "std::find vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, std::vector<int>>(size, 1, 100);
+        auto value = next_random(1, 100);
+        measure(r, [&v, &value]() {
+            do_not_optimize(std::find(v.begin(), v.end(), value));
+        });
+    });
+
+    benchmark(s, "std::find htk::vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int>>(size, 1, 100);
+        auto value = next_random(1, 100);
+        measure(r, [&v, &value]() {
+            do_not_optimize(std::find(v.begin(), v.end(), value));
+        });
+    });
+}
+
+void measure_vector_int_sort(session &s)
+{
+    benchmark(s, "std::sort vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, std::vector<int>>(size, 1, 100);
+        measure(r, [&v]() {
+            std::sort(v.begin(), v.end());
+        });
+    });
+
+    benchmark(s, "std::sort htk::vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int>>(size, 1, 100);
+        measure(r, [&v]() {
+            std::sort(v.begin(), v.end());
+        });
+    });
+}
+
+void measure_vector_int_copy(session &s)
+{
+    benchmark(s, "std::vector<int> copy", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, std::vector<int>>(size);
+        measure(r, [&v]() {
+            std::vector<int> copy(v);
+            do_not_optimize(copy.back());
+        });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "htk::vector<int> push_back copy", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int>>(size);
+        measure(r, [&v]() {
+            htk::vector<int> copy;
+            for (const auto &i : v)
+                copy.push_back(i);
+            do_not_optimize(copy.back());
+        });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "htk::vector<int> copy", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int>>(size);
+        measure(r, [&v]() {
+            htk::vector<int> copy(v);
+            do_not_optimize(copy.back());
+        });
+    }, { 10, 100, 1000 });
+}
+
+// a request builds a few dozen short lived vectors, and throws them all away.
+void measure_arena_vectors(session &s)
+{
+    benchmark(s, "htk::vector<int> 32 per request", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        measure(r, [size]() {
+            for (int i = 0; i < 32; ++i)
+            {
+                htk::vector<int> v;
+                for (int j = 0; j < size; ++j)
+                    v.push_back(j);
+                do_not_optimize(v.back());
+            }
+        });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "htk::vector<int, arena_allocator> 32 per request", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        htk::arena arena(64 * 1024);
+        measure(r, [&arena, size]() {
+            for (int i = 0; i < 32; ++i)
+            {
+                htk::vector<int, htk::arena_allocator<int>> v(arena);
+                for (int j = 0; j < size; ++j)
+                    v.push_back(j);
+                do_not_optimize(v.back());
+            }
+            arena.release();
+        });
+    }, { 10, 100, 1000 });
+}
+
+// runs fn on `threads` threads at once, and waits for them all.
+template <typename Callable>
+void on_threads(int threads, Callable &&fn)
+{
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+        workers.emplace_back(fn);
+    for (auto &w : workers)
+        w.join();
+}
+
+// 1, 2, 4, 8 and 16 threads, as many of them as the machine can run at once.
+std::vector<size_t> thread_counts()
+{
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads <= 16 && threads <= hw; threads *= 2)
+        counts.push_back(threads);
+    return counts;
+}
+
+// each thread churns through short lived vectors, the size here is the thread count.
+template <typename AllocatorT>
+void churn_vectors()
+{
+    for (int i = 0; i < 10000; ++i)
+    {
+        htk::vector<int, AllocatorT> v;
+        for (int j = 0; j < 16; ++j)
+            v.push_back(j);
+        do_not_optimize(v.back());
+    }
+}
+
+void measure_pool_allocator_threads(session &s)
+{
+    const auto threads_to_run = thread_counts();
+
+    benchmark(s, "htk::allocator vector churn / threads", threads_to_run, [](session_run &r, int threads) {
+        measure(r, [threads]() { on_threads(threads, churn_vectors<htk::allocator<int>>); });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::pool_allocator vector churn / threads", threads_to_run, [](session_run &r, int threads) {
+        measure(r, [threads]() { on_threads(threads, churn_vectors<htk::pool_allocator<int>>); });
+    }, { 10, 100 });
+}
+
+// one vector type, whatever's behind it.
+void churn_pmr_vectors(htk::memory_resource *resource, int size)
+{
+    for (int i = 0; i < 32; ++i)
+    {
+        htk::vector<int, htk::polymorphic_allocator<int>> v(resource);
+        for (int j = 0; j < size; ++j)
+            v.push_back(j);
+        do_not_optimize(v.back());
+    }
+}
+
+void measure_memory_resources(session &s)
+{
+    benchmark(s, "pmr vector<int> new_delete_resource", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        measure(r, [size]() { churn_pmr_vectors(htk::new_delete_resource(), size); });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "pmr vector<int> monotonic_buffer_resource", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        htk::monotonic_buffer_resource mono(64 * 1024);
+        measure(r, [&mono, size]() {
+            churn_pmr_vectors(&mono, size);
+            mono.release();
+        });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "pmr vector<int> unsynchronized_pool_resource", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        htk::unsynchronized_pool_resource pool;
+        measure(r, [&pool, size]() { churn_pmr_vectors(&pool, size); });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "pmr vector<int> synchronized_pool_resource", { 10, 100, 1000, 10000 }, [](session_run &r, int size) {
+        htk::synchronized_pool_resource pool;
+        measure(r, [&pool, size]() { churn_pmr_vectors(&pool, size); });
+    }, { 10, 100, 1000 });
+}
+
+// the same fill, with the allocator's traffic in the table.
+void measure_vector_allocations(session &s)
+{
+    static htk::allocation_counters counters;
+
+    benchmark(s, "htk::vector<int> fill", { 10, 100, 1000, 10000, 100000 }, [](session_run &r, int size) {
+        r.attach(counters);
+        measure(r, [size]() {
+            htk::vector<int, htk::counting_allocator<int>> v(counters);
+            for (int i = 0; i < size; ++i)
+                v.push_back(i);
+            do_not_optimize(v.back());
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::vector<int> reserve + fill", { 10, 100, 1000, 10000, 100000 }, [](session_run &r, int size) {
+        r.attach(counters);
+        measure(r, [size]() {
+            htk::vector<int, htk::counting_allocator<int>> v(counters);
+            v.reserve(size);
+            for (int i = 0; i < size; ++i)
+                v.push_back(i);
+            do_not_optimize(v.back());
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::vector<move_only> fill", { 10, 100, 1000, 10000, 100000 }, [](session_run &r, int size) {
+        r.attach(counters);
+        measure(r, [size]() {
+            htk::vector<move_only, htk::counting_allocator<move_only>> v(counters);
+            for (int i = 0; i < size; ++i)
+                v.emplace_back(i);
+            do_not_optimize(v.back());
+        });
+    }, { 10, 100 });
+}
+
+void measure_aligned_vector_sum(session &s)
+{
+    benchmark(s, "htk::vector<int> sum", { 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int>>(size, 0, 100);
+        measure(r, [&v]() { do_not_optimize(std::accumulate(v.begin(), v.end(), 0)); });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "htk::vector<int, aligned_allocator> sum", { 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, htk::vector<int, htk::aligned_allocator<int>>>(size, 0, 100);
+        measure(r, [&v]() { do_not_optimize(std::accumulate(v.begin(), v.end(), 0)); });
+    }, { 10, 100, 1000 });
+}
+
+// writes a sorted table of size ints to path, as a mapped_vector would.
+void write_table(const char *path, int size)
+{
+    std::remove(path);
+    htk::mapped_vector<int> table(path);
+    table.reserve(size);
+    for (int i = 0; i < size; ++i)
+        table.push_back(i * 2);
+}
+
+// what a restart costs: reading the table back in, or just mapping it.
+void measure_mapped_vector_open(session &s)
+{
+    benchmark(s, "read table into htk::vector<int>", { 100000, 1000000, 10000000 }, [](session_run &r, int size) {
+        write_table("table.bin", size);
+        measure(r, []() {
+            std::ifstream in("table.bin", std::ios::binary | std::ios::ate);
+            const auto bytes = static_cast<size_t>(in.tellg());
+            in.seekg(0);
+            htk::vector<int> v;
+            v.resize_default_init(static_cast<htk::size_t>(bytes / sizeof(int)));
+            in.read(reinterpret_cast<char *>(v.data()), bytes);
+            do_not_optimize(std::binary_search(v.begin(), v.end(), 1000));
+        });
+    }, { 10 });
+
+    benchmark(s, "open table as mapped_vector<int>", { 100000, 1000000, 10000000 }, [](session_run &r, int size) {
+        write_table("table.bin", size);
+        measure(r, []() {
+            htk::mapped_vector<int> v("table.bin", htk::map_mode::read_only);
+            do_not_optimize(std::binary_search(v.begin(), v.end(), 1000));
+        });
+    }, { 10 });
+    std::remove("table.bin");
+}
+
+// every emplace is its own lap, so the max column is the worst single one.
+template <typename VectorT>
+void emplace_laps(session_run &r, int size)
+{
+    VectorT v;
+    for (int i = 0; i < size; ++i)
+        measure(r, [&v, i]() { v.emplace_back(i); });
+    do_not_optimize(v.back());
+}
+
+void measure_stable_vector_emplace(session &s)
+{
+    benchmark(s, "std::vector<int> emplace lap", { 1000, 100000, 1000000 }, [](session_run &r, int size) {
+        emplace_laps<std::vector<int>>(r, size);
+    }, { 1, 10 });
+
+    benchmark(s, "htk::vector<int> emplace lap", { 1000, 100000, 1000000 }, [](session_run &r, int size) {
+        emplace_laps<htk::vector<int>>(r, size);
+    }, { 1, 10 });
+
+    benchmark(s, "htk::vector<std::string> emplace lap", { 1000, 100000 }, [](session_run &r, int size) {
+        htk::vector<std::string> v;
+        for (int i = 0; i < size; ++i)
+            measure(r, [&v]() { v.emplace_back("a string long enough for the heap"); });
+    }, { 1, 10 });
+
+    benchmark(s, "htk::stable_vector<int> emplace lap", { 1000, 100000, 1000000 }, [](session_run &r, int size) {
+        emplace_laps<htk::stable_vector<int>>(r, size);
+    }, { 1, 10 });
+
+    benchmark(s, "htk::stable_vector<std::string> emplace lap", { 1000, 100000 }, [](session_run &r, int size) {
+        htk::stable_vector<std::string> v;
+        for (int i = 0; i < size; ++i)
+            measure(r, [&v]() { v.emplace_back("a string long enough for the heap"); });
+    }, { 1, 10 });
+}
+
+// collectors: every thread appends 100000 items to the shared result.
+void measure_concurrent_vector_threads(session &s)
+{
+    const auto threads_to_run = thread_counts();
+
+    benchmark(s, "private htk::vector + merge under mutex / threads", threads_to_run, [](session_run &r, int threads) {
+        measure(r, [threads]() {
+            std::mutex m;
+            htk::vector<int> merged;
+            on_threads(threads, [&m, &merged]() {
+                htk::vector<int> mine;
+                for (int i = 0; i < 100000; ++i)
+                    mine.push_back(i);
+                std::lock_guard<std::mutex> lock(m);
+                merged.append_range(mine);
+            });
+            do_not_optimize(merged.size());
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::concurrent_vector / threads", threads_to_run, [](session_run &r, int threads) {
+        measure(r, [threads]() {
+            htk::concurrent_vector<int> shared;
+            on_threads(threads, [&shared]() {
+                for (int i = 0; i < 100000; ++i)
+                    shared.push_back(i);
+            });
+            do_not_optimize(shared.size());
+        });
+    }, { 10, 100 });
+}
+
+// a 64 byte record where the loop only wants x.
+struct particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    int id;
+    double extra[4];
+};
+
+// sums x over every particle, laid out as an array of structs and as a
+// struct of arrays.
+void measure_soa_column_scan(session &s)
+{
+    benchmark(s, "htk::vector<particle> sum x", { 1000, 100000, 1000000 }, [](session_run &r, int size) {
+        htk::vector<particle> v;
+        for (int i = 0; i < size; ++i)
+            v.push_back(particle{ float(i), 0, 0, 0, 0, 0, 1, i, {} });
+        measure(r, [&v]() {
+            float sum = 0;
+            for (const auto &p : v)
+                sum += p.x;
+            do_not_optimize(sum);
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::soa_vector<particle fields> sum x", { 1000, 100000, 1000000 }, [](session_run &r, int size) {
+        htk::soa_vector<float, float, float, float, float, float, float, int, double, double, double, double> v;
+        for (int i = 0; i < size; ++i)
+            v.emplace_back(float(i), 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, i, 0.0, 0.0, 0.0, 0.0);
+        measure(r, [&v]() {
+            float sum = 0;
+            for (float x : v.column<0>())
+                sum += x;
+            do_not_optimize(sum);
+        });
+    }, { 10, 100 });
+}
+
+// one flag in 16 set, counted and then walked.
+void measure_bitvector_flags(session &s)
+{
+    auto flags = [](int size) {
+        std::mt19937 gen(5);
+        htk::vector<uint8_t> bytes;
+        htk::bitvector<> bits;
+        for (int i = 0; i < size; ++i)
+        {
+            const bool set = gen() % 16 == 0;
+            bytes.push_back(set);
+            bits.push_back(set);
+        }
+        return std::make_pair(htk::move(bytes), htk::move(bits));
+    };
+
+    benchmark(s, "htk::vector<uint8_t> count", { 1000, 100000, 1000000 }, [&flags](session_run &r, int size) {
+        auto v = flags(size).first;
+        measure(r, [&v]() {
+            int count = 0;
+            for (uint8_t f : v)
+                count += f;
+            do_not_optimize(count);
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::bitvector count", { 1000, 100000, 1000000 }, [&flags](session_run &r, int size) {
+        auto v = flags(size).second;
+        measure(r, [&v]() { do_not_optimize(v.count()); });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::vector<uint8_t> walk set", { 1000, 100000, 1000000 }, [&flags](session_run &r, int size) {
+        auto v = flags(size).first;
+        measure(r, [&v]() {
+            size_t sum = 0;
+            for (size_t i = 0; i < v.size(); ++i)
+                if (v.at(i))
+                    sum += i;
+            do_not_optimize(sum);
+        });
+    }, { 10, 100 });
+
+    benchmark(s, "htk::bitvector walk set", { 1000, 100000, 1000000 }, [&flags](session_run &r, int size) {
+        auto v = flags(size).second;
+        measure(r, [&v]() {
+            size_t sum = 0;
+            for (auto i = v.find_first(); i != v.npos; i = v.find_next(i))
+                sum += i;
+            do_not_optimize(sum);
+        });
+    }, { 10, 100 });
+}
+
+// membership tests on short lists, with the value missing so the whole list is read.
+void measure_short_list_find(session &s)
+{
+    auto list = [](int size) {
+        htk::vector<int> v;
+        for (int i = 0; i < size; ++i)
+            v.push_back(i * 2);
+        return v;
+    };
+
+    benchmark(s, "std::find htk::vector<int>", { 64, 256, 1024, 4096 }, [&list](session_run &r, int size) {
+        auto v = list(size);
+        measure(r, [&v]() { do_not_optimize(std::find(v.data(), v.data() + v.size(), -1)); });
+    }, { 100 });
+
+    benchmark(s, "htk::find htk::vector<int>", { 64, 256, 1024, 4096 }, [&list](session_run &r, int size) {
+        auto v = list(size);
+        measure(r, [&v]() { do_not_optimize(htk::find(v.begin(), v.end(), -1)); });
+    }, { 100 });
+
+    benchmark(s, "htk::count htk::vector<int>", { 64, 256, 1024, 4096 }, [&list](session_run &r, int size) {
+        auto v = list(size);
+        measure(r, [&v]() { do_not_optimize(htk::count(v.begin(), v.end(), 2)); });
+    }, { 100 });
+
+    const int needles[] = { -1, -3, -5, -7 };
+    benchmark(s, "std::find_first_of x4 htk::vector<int>", { 64, 256, 1024, 4096 }, [&list, &needles](session_run &r, int size) {
+        auto v = list(size);
+        measure(r, [&v, &needles]() { do_not_optimize(std::find_first_of(v.data(), v.data() + v.size(), needles, needles + 4)); });
+    }, { 100 });
+
+    benchmark(s, "htk::find_if_equal_any x4 htk::vector<int>", { 64, 256, 1024, 4096 }, [&list, &needles](session_run &r, int size) {
+        auto v = list(size);
+        measure(r, [&v, &needles]() { do_not_optimize(htk::find_if_equal_any(v.begin(), v.end(), needles, needles + 4)); });
+    }, { 100 });
+}
+
+// a join's worth of lookups into one sorted table, one search at a time
+// against the whole batch in lock step.
+void measure_batch_lower_bound(session &s)
+{
+    auto table = [](int size) {
+        htk::vector<int> v;
+        v.reserve(size);
+        for (int i = 0; i < size; ++i)
+            v.push_back(i * 2);
+        return v;
+    };
+    auto probes = [](int size) {
+        htk::vector<int> keys;
+        keys.reserve(1000000);
+        for (int i = 0; i < 1000000; ++i)
+            keys.push_back(static_cast<int>(next_random(0, size * 2)));
+        return keys;
+    };
+
+    benchmark(s, "htk::binary_search x1M htk::vector<int>", { 1000, 1000000, 10000000, 100000000 }, [&table, &probes](session_run &r, int size) {
+        const auto v = table(size);
+        auto keys = probes(size);
+        measure(r, [&v, &keys]() {
+            int found = 0;
+            for (const auto key : keys)
+                found += htk::binary_search(v.cbegin(), v.cend(), key);
+            do_not_optimize(found);
+        });
+    }, { 5 });
+
+    benchmark(s, "htk::batch_lower_bound x1M htk::vector<int>", { 1000, 1000000, 10000000, 100000000 }, [&table, &probes](session_run &r, int size) {
+        const auto v = table(size);
+        const auto keys = probes(size);
+        htk::vector<htk::ptrdiff_t> positions;
+        positions.resize(keys.size());
+        measure(r, [&v, &keys, &positions]() {
+            htk::batch_lower_bound(v, keys, positions.data());
+            do_not_optimize(positions.data());
+        });
+    }, { 5 });
+}
+
+// every lap filters its own copy of the keys, about half of which go, so
+// no lap is left a vector that's already been filtered. the copy isn't timed.
+template <typename VectorT, typename EraseT>
+void erase_random_half(session_run &r, int size, EraseT erase)
+{
+    const auto keys = random_numeric_vector<int, std::vector<int>>(size, 1, 100);
+    VectorT v;
+    v.reserve(size);
+    for (const int key : keys)
+        v.push_back(key);
+    measure(r, [&v, &erase]() {
+        erase(v);
+        do_not_optimize(v.size());
+    });
+}
+
+void measure_vector_int_erase_if(session &s)
+{
+    benchmark(s, "std::remove_if + erase vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        erase_random_half<std::vector<int>>(r, size, [](std::vector<int> &v) {
+            v.erase(std::remove_if(v.begin(), v.end(), [](int i) { return i < 50; }), v.end());
+        });
+    }, { 10, 100, 1000 });
+
+    benchmark(s, "htk::erase_if htk::vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        erase_random_half<htk::vector<int>>(r, size, [](htk::vector<int> &v) {
+            htk::erase_if(v, [](int i) { return i < 50; });
+        });
+    }, { 10, 100, 1000 });
+}
+
 void measure_linear_search(session &s)
 {
     benchmark(s, "std::find vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
@@ -361,6 +1103,88 @@ void measure_binary_search(session &s)
     });
 }
 
+// a sorted table of even numbers, and a batch of random keys to look up in it.
+template <typename VectorT, typename SearchT>
+void search_big_table(session_run &r, int size, SearchT search)
+{
+    VectorT table;
+    table.reserve(size);
+    for (int i = 0; i < size; ++i)
+        table.push_back(i * 2);
+
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; ++i)
+        keys.push_back(static_cast<int>(next_random(0, size * 2)));
+
+    measure(r, [&table, &keys, &search]() {
+        int found = 0;
+        for (const auto key : keys)
+            found += search(table.begin(), table.end(), key);
+        do_not_optimize(found);
+    });
+}
+
+template <typename VectorT>
+void search_big_table(session_run &r, int size)
+{
+    search_big_table<VectorT>(r, size, [](auto first, auto last, int key) { return std::binary_search(first, last, key); });
+}
+
+// at these sizes the searches are mostly TLB misses.
+void measure_huge_page_binary_search(session &s)
+{
+    benchmark(s, "std::binary_search x1000 htk::vector<int>", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_table<htk::vector<int>>(r, size);
+    }, { 10 });
+
+    benchmark(s, "std::binary_search x1000 htk::vector<int, huge_page_allocator>", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_table<htk::vector<int, htk::huge_page_allocator<int>>>(r, size);
+    }, { 10 });
+}
+
+// search_big_table's table and keys, looked up through an index built on it.
+template <typename IndexT>
+void search_big_index(session_run &r, int size)
+{
+    std::vector<int> table;
+    table.reserve(size);
+    for (int i = 0; i < size; ++i)
+        table.push_back(i * 2);
+    const IndexT index(table);
+
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; ++i)
+        keys.push_back(static_cast<int>(next_random(0, size * 2)));
+
+    measure(r, [&index, &keys]() {
+        int found = 0;
+        for (const auto key : keys)
+            found += index.contains(key);
+        do_not_optimize(found);
+    });
+}
+
+// past the caches every level of the search is a miss. the prefetch hides
+// one of them, the index layouts put several levels in a line.
+void measure_big_binary_search(session &s)
+{
+    benchmark(s, "std::binary_search x1000 vector<int>", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_table<std::vector<int>>(r, size);
+    }, { 10 });
+
+    benchmark(s, "htk::binary_search x1000 vector<int>", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_table<std::vector<int>>(r, size, [](auto first, auto last, int key) { return htk::binary_search(first, last, key); });
+    }, { 10 });
+
+    benchmark(s, "htk::eytzinger_index x1000", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_index<htk::eytzinger_index<int>>(r, size);
+    }, { 10 });
+
+    benchmark(s, "htk::s_tree_index x1000", { 1000000, 10000000, 100000000 }, [](session_run &r, int size) {
+        search_big_index<htk::s_tree_index<int>>(r, size);
+    }, { 10 });
+}
+
 void measure_htk_binary_search(session &s)
 {
     benchmark(s, "htk::binary_search vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
@@ -371,6 +1195,26 @@ void measure_htk_binary_search(session &s)
             do_not_optimize(htk::binary_search(v.begin(), v.end(), value));
         });
     });
+
+    benchmark(s, "htk::eytzinger_index<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, std::vector<int>>(size, 1, 100);
+        std::sort(v.begin(), v.end());
+        const htk::eytzinger_index<int> index(v);
+        const int value = static_cast<int>(next_random(1, 100));
+        measure(r, [&index, value]() {
+            do_not_optimize(index.contains(value));
+        });
+    });
+
+    benchmark(s, "htk::s_tree_index<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
+        auto v = random_numeric_vector<int, std::vector<int>>(size, 1, 100);
+        std::sort(v.begin(), v.end());
+        const htk::s_tree_index<int> index(v);
+        const int value = static_cast<int>(next_random(1, 100));
+        measure(r, [&index, value]() {
+            do_not_optimize(index.contains(value));
+        });
+    });
 }
 
 void measure_htk_linear_search(session &s)
@@ -385,6 +1229,20 @@ void measure_htk_linear_search(session &s)
     });
 }
 
+// keys over the whole range of T, copied back in before every sort so each
+// run sorts them from scratch. the copy is the same for every sorter.
+template <typename T, typename SortT>
+void sort_random_keys(session_run &r, int size, SortT sort)
+{
+    const auto keys = random_numeric_vector<T, std::vector<T>>(size);
+    std::vector<T> v(keys.size());
+    measure(r, [&keys, &v, &sort]() {
+        std::copy(keys.begin(), keys.end(), v.begin());
+        sort(v);
+        do_not_optimize(v.data());
+    });
+}
+
 void measure_sort(session &s)
 {
     benchmark(s, "std::sort vector<int>", { 10, 100, 1000, 10000, 100000, 1000000 }, [](session_run &r, int size) {
@@ -394,6 +1252,24 @@ void measure_sort(session &s)
             std::sort(v.begin(), v.end());
         });
     });
+
+    benchmark(s, "std::sort random vector<uint32_t>", { 1000, 100000, 10000000, 30000000 }, [](session_run &r, int size) {
+        sort_random_keys<uint32_t>(r, size, [](std::vector<uint32_t> &v) { std::sort(v.begin(), v.end()); });
+    }, { 5 });
+
+    benchmark(s, "htk::radix_sort random vector<uint32_t>", { 1000, 100000, 10000000, 30000000 }, [](session_run &r, int size) {
+        htk::vector<uint32_t> scratch;
+        sort_random_keys<uint32_t>(r, size, [&scratch](std::vector<uint32_t> &v) { htk::radix_sort(v.begin(), v.end(), scratch); });
+    }, { 5 });
+
+    benchmark(s, "std::sort random vector<int64_t>", { 1000, 100000, 10000000, 30000000 }, [](session_run &r, int size) {
+        sort_random_keys<int64_t>(r, size, [](std::vector<int64_t> &v) { std::sort(v.begin(), v.end()); });
+    }, { 5 });
+
+    benchmark(s, "htk::radix_sort random vector<int64_t>", { 1000, 100000, 10000000, 30000000 }, [](session_run &r, int size) {
+        htk::vector<int64_t> scratch;
+        sort_random_keys<int64_t>(r, size, [&scratch](std::vector<int64_t> &v) { htk::radix_sort(v.begin(), v.end(), scratch); });
+    }, { 5 });
 }
 
 int main()
@@ -401,11 +1277,33 @@ int main()
     session s;
     //measure_vector_int_emplace(s);
     //measure_vector_move_only_emplace(s);
+    //measure_small_vector_int_emplace(s);
 
     //measure_vector_int_insert_end(s);
+    //measure_vector_int_append(s);
     //measure_vector_int_insert_mid(s);
     //measure_vector_int_insert_begin(s);
 
+    //measure_vector_resize(s);
+    //measure_vector_int_find(s);
+    //measure_vector_int_sort(s);
+    //measure_vector_int_erase_if(s);
+    //measure_vector_int_copy(s);
+    //measure_arena_vectors(s);
+    //measure_pool_allocator_threads(s);
+    //measure_memory_resources(s);
+    //measure_vector_allocations(s);
+    //measure_aligned_vector_sum(s);
+    //measure_huge_page_binary_search(s);
+    //measure_mapped_vector_open(s);
+    //measure_stable_vector_emplace(s);
+    //measure_concurrent_vector_threads(s);
+    //measure_soa_column_scan(s);
+    //measure_bitvector_flags(s);
+    //measure_big_binary_search(s);
+    //measure_short_list_find(s);
+    //measure_batch_lower_bound(s);
+
     measure_linear_search(s);
     measure_binary_search(s);
     measure_htk_binary_search(s);
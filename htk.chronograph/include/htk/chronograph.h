@@ -81,9 +81,10 @@ namespace chronograph
         }
     }
 
+    // sizes worked out at runtime, like a thread count capped by the machine.
     template <typename Callable>
     typename std::enable_if<std::is_invocable_v<Callable, session_run &, size_t>>::type
-    benchmark(session &s, const std::string &name, std::initializer_list<size_t> sizes, Callable &&fn,  std::initializer_list<size_t> runs = detail::default_runs)
+    benchmark(session &s, const std::string &name, const std::vector<size_t> &sizes, Callable &&fn,  std::initializer_list<size_t> runs = detail::default_runs)
     {
         s.add_column("size");
         for (const auto size : sizes)
@@ -101,6 +102,13 @@ namespace chronograph
         }
     }
 
+    template <typename Callable>
+    typename std::enable_if<std::is_invocable_v<Callable, session_run &, size_t>>::type
+    benchmark(session &s, const std::string &name, std::initializer_list<size_t> sizes, Callable &&fn,  std::initializer_list<size_t> runs = detail::default_runs)
+    {
+        benchmark(s, name, std::vector<size_t>(sizes), std::forward<Callable>(fn), runs);
+    }
+
     struct tag_csv_format
     {
     };
@@ -5,6 +5,8 @@
 #include <htk/statistics.h>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
 
 namespace chronograph
 {
@@ -53,6 +55,21 @@ namespace chronograph
         return s;
     }
 
+    // a run's value for a counter, as text. empty if it didn't report it.
+    inline std::string counter_value(const run &r, const std::string &name)
+    {
+        for (const auto &c : r.counters)
+        {
+            if (c.first == name)
+            {
+                std::stringstream ss;
+                ss << std::setprecision(12) << c.second;
+                return ss.str();
+            }
+        }
+        return std::string();
+    }
+
     template <typename Stream>
     void format_table(Stream &ss, const session &ses)
     {
@@ -62,7 +79,8 @@ namespace chronograph
         for (const auto &run : ses.runs())
             max_width = std::max(run.name.length(), max_width);
         max_width += 3;
-        ss << fill('-', max_width + 70) << std::endl;
+        const auto counters_width = 13 * ses.counters().size();
+        ss << fill('-', max_width + 70 + counters_width) << std::endl;
         ss << std::left << std::setw(max_width) << std::setfill(' ') << "name"
            << std::right << std::setw(10) << std::setfill(' ') << "iterations"
            << std::right << std::setw(10) << std::setfill(' ') << "total"
@@ -71,9 +89,11 @@ namespace chronograph
            << std::right << std::setw(13) << std::setfill(' ') << "min"
            << std::right << std::setw(13) << std::setfill(' ') << "max"
            << std::right << std::setw(13) << std::setfill(' ') << "s-dev"
-           << std::right << std::setw(13) << std::setfill(' ') << "ci (95%)"
-           << "\r\n";
-        ss << fill('-', max_width + 70) << std::endl;
+           << std::right << std::setw(13) << std::setfill(' ') << "ci (95%)";
+        for (const auto &name : ses.counters())
+            ss << std::right << std::setw(13) << std::setfill(' ') << name;
+        ss << "\r\n";
+        ss << fill('-', max_width + 70 + counters_width) << std::endl;
 
         std::pair<bool, int> group;
         for (const auto &run : ses.runs())
@@ -97,8 +117,10 @@ namespace chronograph
                << std::right << std::setw(10) << std::setfill(' ') << stats.min << " " << dtraits::unit << " "
                << std::right << std::setw(10) << std::setfill(' ') << stats.max << " " << dtraits::unit << " "
                << std::right << std::setw(10) << std::setfill(' ') << stats.stddev << " " << dtraits::unit << " "
-               << std::right << std::setw(10) << std::setfill(' ') << stats.ci << " " << dtraits::unit << " "
-               << "\r\n";
+               << std::right << std::setw(10) << std::setfill(' ') << stats.ci << " " << dtraits::unit << " ";
+            for (const auto &name : ses.counters())
+                ss << std::right << std::setw(13) << std::setfill(' ') << counter_value(run, name);
+            ss << "\r\n";
         }
     }
 
@@ -120,6 +142,8 @@ namespace chronograph
            << ",max"
            << ",s-dev"
            << ",ci (95%)";
+        for (const auto &name : ses.counters())
+            ss << "," << name;
 
 
 
@@ -142,6 +166,8 @@ namespace chronograph
             << std::setprecision(8) << stats.max << ", "
             << std::setprecision(8) << stats.stddev << ", "
             << std::setprecision(8) << stats.ci << " ";
+            for (const auto &name : ses.counters())
+                ss << ", " << counter_value(run, name);
 
 
             ss << "\n";
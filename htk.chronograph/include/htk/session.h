@@ -2,7 +2,10 @@
 #define __session_h__
 
 #include <htk/lap.h>
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace chronograph
@@ -29,6 +32,8 @@ namespace chronograph
         lap total;
         std::vector<lap> laps;
         std::vector<std::string> columns;
+        // name and value of each counter attached to the run.
+        std::vector<std::pair<std::string, double>> counters;
     };
 
     class session
@@ -82,10 +87,23 @@ namespace chronograph
             return columns_;
         }
 
+        // every counter name any run has reported, in the order first seen.
+        void add_counter(const std::string &name)
+        {
+            if (std::find(counters_.begin(), counters_.end(), name) == counters_.end())
+                counters_.emplace_back(name);
+        }
+
+        const std::vector<std::string> &counters() const
+        {
+            return counters_;
+        }
+
     private:
         session_context context_;
         std::vector<run> runs_;
         std::vector<std::string> columns_;
+        std::vector<std::string> counters_;
         int group_;
     };
 
@@ -104,6 +122,8 @@ namespace chronograph
             if (index_ == -1)
                 throw std::exception("bad run");
             session_.end_run(index_);
+            if (collect_)
+                collect_();
         }
         void record(const lap &l)
         {
@@ -117,10 +137,35 @@ namespace chronograph
             run_->columns.emplace_back(ss.str());
         }
 
+        /*
+            Reports a set of counters with the run, anything that has a reset()
+            and a for_each_counter(counters, fn(name, value)) that ADL can find,
+            like htk::allocation_counters. They're reset when first attached,
+            and read when the run ends, so they count everything in between.
+            Attaching the same counters again, every iteration say, is fine.
+        */
+        template <typename Counters>
+        void attach(Counters &counters)
+        {
+            if (attached_ == &counters)
+                return;
+            attached_ = &counters;
+            counters.reset();
+            collect_ = [this, &counters]() {
+                run_->counters.clear();
+                for_each_counter(counters, [this](const char *name, auto value) {
+                    session_.add_counter(name);
+                    run_->counters.emplace_back(name, static_cast<double>(value));
+                });
+            };
+        }
+
     private:
         int index_;
         session &session_;
         run *run_;
+        const void *attached_ = nullptr;
+        std::function<void()> collect_;
     };
 }
 
@@ -1,5 +1,13 @@
 #include "gtest/gtest.h"
 #include <htk/algorithm.h>
+#include <htk/vector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <vector>
 
 TEST(htk_algorithm_tests, test_binary_search_simple_true)
 {
@@ -21,3 +29,245 @@ TEST(htk_algorithm_tests, test_binary_search_simple_false)
     EXPECT_FALSE(htk::binary_search(v.begin(), v.end(), 5));
 }
 
+TEST(htk_algorithm_tests, test_binary_search_empty)
+{
+    std::vector<int> v;
+    EXPECT_FALSE(htk::binary_search(v.begin(), v.end(), 1));
+    EXPECT_EQ(v.end(), htk::lower_bound(v.begin(), v.end(), 1));
+    EXPECT_EQ(v.end(), htk::upper_bound(v.begin(), v.end(), 1));
+}
+
+TEST(htk_algorithm_tests, test_bounds_match_std)
+{
+    for (size_t size : { 1, 2, 3, 7, 8, 100, 1000, 4097 })
+    {
+        std::vector<int> v;
+        for (size_t i = 0; i < size; ++i)
+            v.push_back(static_cast<int>((i * 7919) % 53));
+        std::sort(v.begin(), v.end());
+
+        for (int value = -1; value <= 54; ++value)
+        {
+            EXPECT_EQ(std::lower_bound(v.begin(), v.end(), value), htk::lower_bound(v.begin(), v.end(), value));
+            EXPECT_EQ(std::upper_bound(v.begin(), v.end(), value), htk::upper_bound(v.begin(), v.end(), value));
+            EXPECT_EQ(std::equal_range(v.begin(), v.end(), value), htk::equal_range(v.begin(), v.end(), value));
+            EXPECT_EQ(std::binary_search(v.begin(), v.end(), value), htk::binary_search(v.begin(), v.end(), value));
+        }
+    }
+}
+
+TEST(htk_algorithm_tests, test_bounds_with_comparator)
+{
+    std::vector<int> v{ 9, 7, 7, 5, 3, 1 };
+    const auto greater = [](int l, int r) { return l > r; };
+    EXPECT_EQ(1, htk::lower_bound(v.begin(), v.end(), 7, greater) - v.begin());
+    EXPECT_EQ(3, htk::upper_bound(v.begin(), v.end(), 7, greater) - v.begin());
+    EXPECT_TRUE(htk::binary_search(v.begin(), v.end(), 3, greater));
+    EXPECT_FALSE(htk::binary_search(v.begin(), v.end(), 4, greater));
+}
+
+TEST(htk_algorithm_tests, test_bounds_on_htk_vector)
+{
+    htk::vector<int> v{ 1, 2, 2, 2, 5 };
+    const auto range = htk::equal_range(v.begin(), v.end(), 2);
+    EXPECT_EQ(1, range.first - v.begin());
+    EXPECT_EQ(4, range.second - v.begin());
+    EXPECT_EQ(v.end(), htk::lower_bound(v.begin(), v.end(), 6));
+}
+
+TEST(htk_algorithm_tests, test_batch_lower_bound_matches_std)
+{
+    // key counts either side of a whole number of groups.
+    for (size_t size : { 1, 2, 7, 100, 4097 })
+    {
+        htk::vector<int> v;
+        for (size_t i = 0; i < size; ++i)
+            v.push_back(static_cast<int>((i * 7919) % 53));
+        std::sort(v.data(), v.data() + v.size());
+
+        for (int key_count : { 1, 15, 16, 17, 56 })
+        {
+            std::vector<int> keys;
+            for (int i = 0; i < key_count; ++i)
+                keys.push_back((i * 31) % 56 - 1);
+
+            std::vector<htk::ptrdiff_t> positions(keys.size(), -1);
+            const auto last = htk::batch_lower_bound(v, keys, positions.begin());
+            EXPECT_EQ(positions.end(), last);
+            for (size_t i = 0; i < keys.size(); ++i)
+                EXPECT_EQ(std::lower_bound(v.data(), v.data() + v.size(), keys[i]) - v.data(), positions[i]);
+        }
+    }
+}
+
+TEST(htk_algorithm_tests, test_batch_lower_bound_empty)
+{
+    const std::vector<int> none;
+    const std::vector<int> keys{ 1, 2, 3 };
+    std::vector<int> positions;
+    htk::batch_lower_bound(none, keys, std::back_inserter(positions));
+    EXPECT_EQ(std::vector<int>({ 0, 0, 0 }), positions);
+
+    positions.clear();
+    htk::batch_lower_bound(keys, none, std::back_inserter(positions));
+    EXPECT_TRUE(positions.empty());
+}
+
+TEST(htk_algorithm_tests, test_batch_lower_bound_with_comparator)
+{
+    const std::vector<int> v{ 9, 7, 7, 5, 3, 1 };
+    const std::list<int> keys{ 7, 10, 0, 4 };
+    std::vector<int> positions;
+    htk::batch_lower_bound(v, keys, std::back_inserter(positions), [](int l, int r) { return l > r; });
+    EXPECT_EQ(std::vector<int>({ 1, 0, 6, 4 }), positions);
+}
+
+
+template <typename T>
+void expect_remove_if_matches_std(size_t size)
+{
+    std::vector<T> v;
+    for (size_t i = 0; i < size; ++i)
+        v.push_back(static_cast<T>((i * 7919) % 101));
+    auto expected = v;
+
+    const auto pred = [](T item) { return item < T(50); };
+    const auto last = htk::remove_if(v.begin(), v.end(), pred);
+    expected.erase(std::remove_if(expected.begin(), expected.end(), pred), expected.end());
+
+    ASSERT_EQ(expected.size(), static_cast<size_t>(last - v.begin()));
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(expected[i], v[i]);
+}
+
+TEST(htk_algorithm_tests, test_remove_if_compacts)
+{
+    for (size_t size : { 0, 1, 3, 4, 5, 16, 17, 1000 })
+    {
+        expect_remove_if_matches_std<int16_t>(size);
+        expect_remove_if_matches_std<int>(size);
+        expect_remove_if_matches_std<float>(size);
+        expect_remove_if_matches_std<uint64_t>(size);
+        expect_remove_if_matches_std<uint8_t>(size);
+    }
+}
+
+TEST(htk_algorithm_tests, test_remove_if_scalar_matches_simd)
+{
+    std::vector<int> v;
+    for (int i = 0; i < 1001; ++i)
+        v.push_back(i);
+    auto v2 = v;
+
+    auto pred = [](int i) { return (i & 5) == 0; };
+    const auto last = htk::detail::compact_scalar(v.data(), v.data() + v.size(), v.data(), pred);
+    const auto last2 = htk::remove_if(v2.begin(), v2.end(), pred);
+
+    ASSERT_EQ(last - v.data(), last2 - v2.begin());
+    for (int i = 0; i < last - v.data(); ++i)
+        EXPECT_EQ(v[i], v2[i]);
+}
+
+template <typename T>
+void expect_find_matches_std(size_t size)
+{
+    htk::vector<T> v;
+    for (size_t i = 0; i < size; ++i)
+        v.push_back(static_cast<T>((i * 7919) % 61));
+
+    for (int value : { 0, 7, 60, 61 })
+    {
+        const T needle = static_cast<T>(value);
+        const auto expected = std::find(v.begin(), v.end(), needle);
+        EXPECT_EQ(expected - v.begin(), htk::find(v.begin(), v.end(), needle) - v.begin()) << size << " " << value;
+        EXPECT_EQ(std::count(v.begin(), v.end(), needle), htk::count(v.begin(), v.end(), needle)) << size << " " << value;
+        EXPECT_EQ(expected != v.end(), htk::linear_search(v.begin(), v.end(), needle));
+    }
+
+    const T needles[] = { T(61), T(40), T(59) };
+    const auto expected = std::find_first_of(v.begin(), v.end(), needles, needles + 3);
+    EXPECT_EQ(expected - v.begin(), htk::find_if_equal_any(v.begin(), v.end(), needles, needles + 3) - v.begin()) << size;
+}
+
+TEST(htk_algorithm_tests, test_find_matches_std)
+{
+    for (size_t size : { 0, 1, 7, 8, 15, 16, 17, 31, 33, 64, 65, 1000 })
+    {
+        expect_find_matches_std<int8_t>(size);
+        expect_find_matches_std<uint16_t>(size);
+        expect_find_matches_std<int>(size);
+        expect_find_matches_std<uint64_t>(size);
+        expect_find_matches_std<float>(size);
+        expect_find_matches_std<double>(size);
+    }
+}
+
+TEST(htk_algorithm_tests, test_find_kernels_agree)
+{
+    std::vector<int64_t> v;
+    for (int64_t i = 0; i < 1000; ++i)
+        v.push_back(i % 3 == 0 ? i : -i);
+    const int64_t *first = v.data();
+    const int64_t *last = first + v.size();
+    const int64_t needles[] = { -998, 999 };
+
+    EXPECT_EQ(htk::detail::find_scalar(first, last, int64_t(-500)), htk::detail::find(first, last, int64_t(-500)));
+    EXPECT_EQ(htk::detail::count_scalar(first, last, int64_t(0)), htk::detail::count(first, last, int64_t(0)));
+    EXPECT_EQ(htk::detail::find_any_scalar(first, last, needles, 2), htk::detail::find_any(first, last, needles, 2));
+#if HTK_X86
+    EXPECT_EQ(first + 500, htk::detail::find_sse2(first, last, int64_t(-500)));
+    EXPECT_EQ(1u, htk::detail::count_sse2(first, last, int64_t(0)));
+    EXPECT_EQ(first + 998, htk::detail::find_any_sse2(first, last, needles, 2));
+
+    // the SSE2 64 bit compare is two 32 bit ones, both halves have to match.
+    const int64_t high_half_differs = (int64_t(1) << 32) + 3;
+    EXPECT_EQ(last, htk::detail::find_sse2(first, last, high_half_differs));
+    EXPECT_EQ(0u, htk::detail::count_sse2(first, last, high_half_differs));
+#endif
+}
+
+TEST(htk_algorithm_tests, test_find_floats_follow_equality)
+{
+    htk::vector<float> v{ 1.0f, -0.0f, std::numeric_limits<float>::quiet_NaN(), 2.0f };
+    EXPECT_EQ(1, htk::find(v.begin(), v.end(), 0.0f) - v.begin());
+    EXPECT_EQ(v.end(), htk::find(v.begin(), v.end(), std::numeric_limits<float>::quiet_NaN()));
+    EXPECT_EQ(0, htk::count(v.begin(), v.end(), std::numeric_limits<float>::quiet_NaN()));
+}
+
+TEST(htk_algorithm_tests, test_find_with_other_value_types)
+{
+    htk::vector<uint8_t> v{ 1, 2, 255, 3 };
+    // 255 + 256 isn't any uint8_t, nothing matches.
+    EXPECT_EQ(v.end(), htk::find(v.begin(), v.end(), 511));
+    EXPECT_EQ(2, htk::find(v.begin(), v.end(), 255) - v.begin());
+    EXPECT_EQ(v.end(), htk::find(v.begin(), v.end(), -1));
+    EXPECT_EQ(1, htk::count(v.begin(), v.end(), size_t(3)));
+
+    const std::list<int> l{ 4, 5, 6 };
+    EXPECT_EQ(6, *htk::find(l.begin(), l.end(), 6));
+    const int needles[] = { 9, 5 };
+    EXPECT_EQ(5, *htk::find_if_equal_any(l.begin(), l.end(), needles, needles + 2));
+}
+
+TEST(htk_algorithm_tests, test_find_if_equal_any_many_needles)
+{
+    htk::vector<int> v;
+    for (int i = 0; i < 100; ++i)
+        v.push_back(i);
+    std::vector<int> needles;
+    for (int i = 0; i < 20; ++i)
+        needles.push_back(1000 + i);
+    EXPECT_EQ(v.end(), htk::find_if_equal_any(v.begin(), v.end(), needles.begin(), needles.end()));
+    needles.push_back(77);
+    EXPECT_EQ(77, htk::find_if_equal_any(v.begin(), v.end(), needles.begin(), needles.end()) - v.begin());
+}
+
+TEST(htk_algorithm_tests, test_remove)
+{
+    std::vector<int> v{ 1, 2, 1, 3 };
+    v.erase(htk::remove(v.begin(), v.end(), 1), v.end());
+
+    ASSERT_EQ(2, v.size());
+    EXPECT_EQ(2, v[0]);
+    EXPECT_EQ(3, v[1]);
+}
@@ -3,4 +3,526 @@
 TEST(TestCaseName, TestName) {
   EXPECT_EQ(1, 1);
   EXPECT_TRUE(true);
-}
\ No newline at end of file
+}
+#include <htk/huge_page_allocator.h>
+#include <htk/memory.h>
+#include <htk/vector.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// arena
+TEST(htk_stl_arena_tests, arena_allocations_are_aligned)
+{
+    htk::arena a;
+    a.allocate(1, 1);
+    void *p = a.allocate(sizeof(double), alignof(double));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % alignof(double));
+    void *q = a.allocate(16, 16);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(q) % 16);
+}
+
+TEST(htk_stl_arena_tests, arena_carves_from_buffer)
+{
+    alignas(16) char buffer[256];
+    htk::arena a(buffer, sizeof(buffer));
+
+    char *p = static_cast<char *>(a.allocate(64, 1));
+    char *q = static_cast<char *>(a.allocate(64, 1));
+    EXPECT_EQ(buffer, p);
+    EXPECT_EQ(buffer + 64, q);
+    EXPECT_EQ(128, a.available());
+}
+
+TEST(htk_stl_arena_tests, arena_spills_to_chunks)
+{
+    alignas(16) char buffer[64];
+    htk::arena a(buffer, sizeof(buffer), 128);
+
+    a.allocate(64, 1);
+    char *p = static_cast<char *>(a.allocate(100, 1));
+    EXPECT_TRUE(p < buffer || p >= buffer + sizeof(buffer));
+
+    // bigger than any chunk so far
+    char *big = static_cast<char *>(a.allocate(10000, 8));
+    memset(big, 0, 10000);
+}
+
+TEST(htk_stl_arena_tests, arena_padding_past_the_buffer_spills)
+{
+    // 10 bytes starting one past a 16 byte boundary, the next boundary is
+    // past the end.
+    alignas(16) char buffer[32];
+    htk::arena a(buffer + 1, 10);
+
+    char *p = static_cast<char *>(a.allocate(8, 16));
+    EXPECT_TRUE(p < buffer || p >= buffer + sizeof(buffer));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 16);
+    EXPECT_LT(a.available(), htk::arena::default_chunk_size);
+}
+
+TEST(htk_stl_arena_tests, arena_release_starts_over)
+{
+    alignas(16) char buffer[64];
+    htk::arena a(buffer, sizeof(buffer));
+    a.allocate(1000, 1);
+    a.release();
+
+    EXPECT_EQ(buffer, a.allocate(8, 1));
+}
+
+TEST(htk_stl_arena_tests, arena_deallocate_last_rolls_back)
+{
+    htk::arena a;
+    void *p = a.allocate(32, 8);
+    a.deallocate(p, 32);
+    EXPECT_EQ(p, a.allocate(32, 8));
+}
+
+TEST(htk_stl_arena_tests, arena_reallocate_last_in_place)
+{
+    htk::arena a;
+    int *p = static_cast<int *>(a.allocate(4 * sizeof(int), alignof(int)));
+    p[3] = 42;
+    int *q = static_cast<int *>(a.reallocate(p, 4 * sizeof(int), 8 * sizeof(int), alignof(int)));
+    EXPECT_EQ(p, q);
+
+    a.allocate(1, 1);
+    int *r = static_cast<int *>(a.reallocate(q, 8 * sizeof(int), 16 * sizeof(int), alignof(int)));
+    EXPECT_NE(q, r);
+    EXPECT_EQ(42, r[3]);
+}
+
+TEST(htk_stl_arena_tests, arena_vector_grows_in_place)
+{
+    htk::arena a(1 << 16);
+    htk::vector<int, htk::arena_allocator<int>> v(a);
+    v.push_back(0);
+    const int *first = v.data();
+    for (int i = 1; i < 1000; ++i)
+        v.push_back(i);
+
+    EXPECT_EQ(first, v.data());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, v.at(i));
+}
+
+TEST(htk_stl_arena_tests, arena_vector_of_classes)
+{
+    htk::arena a;
+    htk::vector<std::string, htk::arena_allocator<std::string>> v(a);
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back(std::to_string(i) + " is a string long enough to be on the heap");
+
+    EXPECT_EQ(100, v.size());
+    EXPECT_EQ(std::string("42 is a string long enough to be on the heap"), v.at(42));
+}
+
+TEST(htk_stl_arena_tests, arena_allocators_compare_by_arena)
+{
+    htk::arena a;
+    htk::arena b;
+    EXPECT_TRUE(htk::arena_allocator<int>(a) == htk::arena_allocator<double>(a));
+    EXPECT_TRUE(htk::arena_allocator<int>(a) != htk::arena_allocator<int>(b));
+}
+
+// pool
+TEST(htk_stl_pool_tests, pool_reuses_freed_block)
+{
+    htk::pool_allocator<int> a;
+    int *p = a.allocate(10);
+    a.deallocate(p, 10);
+    int *q = a.allocate(12);
+    EXPECT_EQ(p, q);
+    a.deallocate(q, 12);
+}
+
+TEST(htk_stl_pool_tests, pool_size_classes)
+{
+    using classes = htk::detail::pool_size_classes;
+    EXPECT_EQ(0, classes::index(1));
+    EXPECT_EQ(0, classes::index(16));
+    EXPECT_EQ(1, classes::index(17));
+    EXPECT_EQ(1, classes::index(32));
+    EXPECT_EQ(classes::count - 1, classes::index(classes::largest));
+}
+
+TEST(htk_stl_pool_tests, pool_large_allocations)
+{
+    htk::pool_allocator<char> a;
+    char *p = a.allocate(1 << 20);
+    memset(p, 1, 1 << 20);
+    a.deallocate(p, 1 << 20);
+}
+
+TEST(htk_stl_pool_tests, pool_vector)
+{
+    htk::vector<std::string, htk::pool_allocator<std::string>> v;
+    for (int i = 0; i < 1000; ++i)
+        v.emplace_back(std::to_string(i));
+
+    EXPECT_EQ(std::string("999"), v.at(999));
+}
+
+TEST(htk_stl_pool_tests, pool_frees_across_threads)
+{
+    htk::pool_allocator<int> a;
+    std::vector<int *> blocks;
+    for (int i = 0; i < 1000; ++i)
+    {
+        blocks.push_back(a.allocate(4));
+        *blocks.back() = i;
+    }
+
+    std::thread freer([&blocks]() {
+        htk::pool_allocator<int> b;
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_EQ(i, *blocks[i]);
+            b.deallocate(blocks[i], 4);
+        }
+    });
+    freer.join();
+
+    // and they can be handed out again, by anyone.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([]() {
+            htk::vector<int, htk::pool_allocator<int>> v;
+            for (int i = 0; i < 10000; ++i)
+                v.push_back(i);
+            EXPECT_EQ(9999, v.at(9999));
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+// memory resources
+template <typename T>
+using pmr_vector = htk::vector<T, htk::polymorphic_allocator<T>>;
+
+// counts what goes through it, on to new_delete_resource.
+struct counting_resource : public htk::memory_resource
+{
+    int allocations = 0;
+    int deallocations = 0;
+
+protected:
+    void *do_allocate(htk::size_t bytes, htk::size_t align) override
+    {
+        ++allocations;
+        return htk::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, htk::size_t bytes, htk::size_t align) override
+    {
+        ++deallocations;
+        htk::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const htk::memory_resource &rhs) const noexcept override
+    {
+        return this == &rhs;
+    }
+};
+
+TEST(htk_stl_memory_resource_tests, default_resource)
+{
+    EXPECT_EQ(htk::new_delete_resource(), htk::get_default_resource());
+
+    counting_resource counter;
+    EXPECT_EQ(htk::new_delete_resource(), htk::set_default_resource(&counter));
+    {
+        pmr_vector<int> v;
+        v.push_back(1);
+        EXPECT_EQ(&counter, v.get_allocator().resource());
+    }
+    EXPECT_EQ(&counter, htk::set_default_resource(nullptr));
+    EXPECT_EQ(htk::new_delete_resource(), htk::get_default_resource());
+    EXPECT_EQ(1, counter.allocations);
+    EXPECT_EQ(1, counter.deallocations);
+}
+
+TEST(htk_stl_memory_resource_tests, new_delete_over_aligned)
+{
+    void *p = htk::new_delete_resource()->allocate(100, 64);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 64);
+    htk::new_delete_resource()->deallocate(p, 100, 64);
+}
+
+TEST(htk_stl_memory_resource_tests, monotonic_vector)
+{
+    alignas(16) char buffer[1024];
+    htk::monotonic_buffer_resource mono(buffer, sizeof(buffer));
+    pmr_vector<int> v(&mono);
+    for (int i = 0; i < 10; ++i)
+        v.push_back(i);
+
+    EXPECT_GE(v.data(), reinterpret_cast<int *>(buffer));
+    EXPECT_LT(v.data(), reinterpret_cast<int *>(buffer + sizeof(buffer)));
+    EXPECT_EQ(9, v.at(9));
+}
+
+TEST(htk_stl_memory_resource_tests, pool_resource_reuses_blocks)
+{
+    counting_resource counter;
+    {
+        htk::unsynchronized_pool_resource pool(&counter);
+        void *p = pool.allocate(24);
+        pool.deallocate(p, 24);
+        EXPECT_EQ(p, pool.allocate(20));
+
+        for (int i = 0; i < 100; ++i)
+            pool.allocate(24);
+        EXPECT_LT(counter.allocations, 10);
+    }
+    EXPECT_EQ(counter.allocations, counter.deallocations);
+}
+
+TEST(htk_stl_memory_resource_tests, pool_resource_large_and_aligned)
+{
+    counting_resource counter;
+    {
+        htk::unsynchronized_pool_resource pool(&counter);
+        void *big = pool.allocate(1 << 20);
+        memset(big, 0, 1 << 20);
+        void *aligned = pool.allocate(48, 64);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % 64);
+        void *kept = pool.allocate(1 << 17, 32);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(kept) % 32);
+        pool.deallocate(big, 1 << 20);
+        pool.deallocate(aligned, 48, 64);
+        EXPECT_EQ(2, counter.deallocations);
+        // kept is left to release()
+    }
+    EXPECT_EQ(counter.allocations, counter.deallocations);
+}
+
+TEST(htk_stl_memory_resource_tests, pool_resource_vectors)
+{
+    htk::unsynchronized_pool_resource pool;
+    pmr_vector<std::string> strings(&pool);
+    pmr_vector<int> ints(&pool);
+    for (int i = 0; i < 1000; ++i)
+    {
+        strings.emplace_back(std::to_string(i));
+        ints.push_back(i);
+    }
+    EXPECT_EQ(std::string("500"), strings.at(500));
+    EXPECT_EQ(999, ints.at(999));
+}
+
+TEST(htk_stl_memory_resource_tests, synchronized_pool_threads)
+{
+    htk::synchronized_pool_resource pool;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < 100; ++i)
+            {
+                pmr_vector<int> v(&pool);
+                for (int j = 0; j < 100; ++j)
+                    v.push_back(j);
+                EXPECT_EQ(99, v.at(99));
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+TEST(htk_stl_memory_resource_tests, polymorphic_allocator_copy_uses_default)
+{
+    htk::unsynchronized_pool_resource pool;
+    pmr_vector<int> v(&pool);
+    v.push_back(1);
+    pmr_vector<int> copy(v);
+
+    EXPECT_EQ(htk::get_default_resource(), copy.get_allocator().resource());
+    EXPECT_TRUE(htk::polymorphic_allocator<int>(&pool) != copy.get_allocator());
+    EXPECT_TRUE(htk::polymorphic_allocator<int>(&pool) == htk::polymorphic_allocator<double>(&pool));
+}
+
+// counting
+TEST(htk_stl_counting_allocator_tests, counts_vector_growth)
+{
+    htk::allocation_counters counters;
+    {
+        htk::vector<int, htk::counting_allocator<int>, htk::exact_growth<4>> v(counters);
+        for (int i = 0; i < 4; ++i)
+            v.push_back(i);
+        EXPECT_EQ(1, counters.allocations);
+        EXPECT_EQ(4 * sizeof(int), counters.bytes);
+
+        v.push_back(4);
+        // int relocates, and the default allocator can realloc
+        EXPECT_EQ(1, counters.reallocations);
+        EXPECT_TRUE(counters.counts_reallocations);
+        EXPECT_EQ(5 * sizeof(int), counters.live);
+    }
+    EXPECT_EQ(1, counters.deallocations);
+    EXPECT_EQ(0, counters.live);
+    EXPECT_EQ(5 * sizeof(int), counters.peak_live);
+}
+
+TEST(htk_stl_counting_allocator_tests, counts_without_reallocate)
+{
+    htk::allocation_counters counters;
+    {
+        using alloc = htk::counting_allocator<std::string, htk::pool_allocator<std::string>>;
+        static_assert(!htk::allocator_can_reallocate_v<alloc>, "pool_allocator can't reallocate");
+        htk::vector<std::string, alloc, htk::exact_growth<2>> v(alloc{ counters });
+        v.emplace_back("a");
+        v.emplace_back("b");
+        v.emplace_back("c");
+        EXPECT_EQ(2, counters.allocations);
+        EXPECT_EQ(1, counters.deallocations);
+        // it grew, but not by reallocating.
+        EXPECT_FALSE(counters.counts_reallocations);
+        EXPECT_EQ(5 * sizeof(std::string), counters.peak_live);
+    }
+    EXPECT_EQ(0, counters.live);
+
+    counters.reset();
+    EXPECT_EQ(0, counters.allocations);
+}
+
+TEST(htk_stl_counting_allocator_tests, counters_past_4gb)
+{
+    // only counted, nothing is allocated.
+    const uint64_t gb = uint64_t(1) << 30;
+    htk::allocation_counters counters;
+    counters.allocated(5 * gb);
+    EXPECT_EQ(5 * gb, counters.peak_live);
+    counters.reallocated(5 * gb, 6 * gb);
+    EXPECT_EQ(6 * gb, counters.peak_live);
+    counters.deallocated(6 * gb);
+    EXPECT_EQ(0, counters.live);
+    EXPECT_EQ(6 * gb, counters.peak_live);
+}
+
+TEST(htk_stl_counting_allocator_tests, for_each_counter_names)
+{
+    htk::allocation_counters counters;
+    counters.allocated(10);
+    counters.counts_reallocations = true;
+    std::vector<std::string> names;
+    for_each_counter(counters, [&names](const char *name, uint64_t) { names.emplace_back(name); });
+
+    EXPECT_EQ(4, names.size());
+    EXPECT_EQ(std::string("allocs"), names.front());
+
+    // nothing that could reallocate, no reallocs.
+    counters.counts_reallocations = false;
+    names.clear();
+    for_each_counter(counters, [&names](const char *name, uint64_t) { names.emplace_back(name); });
+    EXPECT_EQ(3, names.size());
+    EXPECT_EQ(names.end(), std::find(names.begin(), names.end(), "reallocs"));
+}
+
+// aligned
+TEST(htk_stl_aligned_allocator_tests, vector_data_is_aligned)
+{
+    htk::vector<float, htk::aligned_allocator<float>> v;
+    for (int i = 0; i < 1000; ++i)
+    {
+        v.push_back(static_cast<float>(i));
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(v.data()) % htk::cache_line_size);
+    }
+    EXPECT_EQ(999.0f, v.at(999));
+}
+
+TEST(htk_stl_aligned_allocator_tests, aligned_to_32)
+{
+    htk::aligned_allocator<double, 32> a;
+    double *p = a.allocate(3);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 32);
+    a.deallocate(p, 3);
+}
+
+TEST(htk_stl_aligned_allocator_tests, padded_to_whole_lines)
+{
+    using padded = htk::aligned_allocator<int, 64, true>;
+    EXPECT_EQ(64, padded::padded(1));
+    EXPECT_EQ(64, padded::padded(16));
+    EXPECT_EQ(128, padded::padded(17));
+    EXPECT_EQ(68, (htk::aligned_allocator<int, 64>::padded(17)));
+
+    htk::vector<int, padded> v{ 1, 2, 3 };
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(v.data()) % 64);
+}
+
+// huge pages
+TEST(htk_stl_huge_page_allocator_tests, small_requests_use_allocator)
+{
+    using alloc = htk::huge_page_allocator<int>;
+    EXPECT_FALSE(alloc::is_huge(1000));
+    EXPECT_TRUE(alloc::is_huge(alloc::threshold / sizeof(int)));
+}
+
+TEST(htk_stl_huge_page_allocator_tests, huge_block_is_page_aligned)
+{
+    htk::huge_page_allocator<char> a;
+    const htk::size_t size = 3 * 1024 * 1024;
+    char *p = a.allocate(size);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 4096);
+    memset(p, 7, size);
+    a.deallocate(p, size);
+}
+
+TEST(htk_stl_huge_page_allocator_tests, round_up_past_4gb)
+{
+    using pages = htk::detail::huge_pages;
+    if (sizeof(pages::byte_count) <= 4)
+        return;
+    const pages::byte_count gb = pages::byte_count(1) << 30;
+    EXPECT_EQ(5 * gb, pages::round_up(5 * gb));
+    EXPECT_EQ(5 * gb, pages::round_up(5 * gb - 1));
+    EXPECT_EQ(5 * gb + pages::page_size(), pages::round_up(5 * gb + 1));
+    EXPECT_THROW(pages::round_up(pages::byte_count(-1)), htk::bad_alloc);
+}
+
+TEST(htk_stl_huge_page_allocator_tests, allocate_past_4gb)
+{
+    if (sizeof(htk::detail::huge_pages::byte_count) <= 4)
+        return;
+    htk::huge_page_allocator<uint64_t> a;
+    const htk::size_t count = (htk::size_t(1) << 29) + 1;
+    EXPECT_EQ((uint64_t(4) << 30) + 8, a.bytes(count));
+
+    uint64_t *p = nullptr;
+    try
+    {
+        p = a.allocate(count);
+    }
+    catch (const htk::bad_alloc &)
+    {
+        // the machine won't map 4GB, nothing more to check here.
+        return;
+    }
+    // only the ends are touched, the pages in between are never backed.
+    p[0] = 1;
+    p[count - 1] = 2;
+    EXPECT_EQ(1, p[0]);
+    EXPECT_EQ(2, p[count - 1]);
+    a.deallocate(p, count);
+}
+
+TEST(htk_stl_huge_page_allocator_tests, vector_grows_across_threshold)
+{
+    htk::vector<int, htk::huge_page_allocator<int>> v;
+    for (int i = 0; i < 2000000; ++i)
+        v.push_back(i);
+
+    EXPECT_TRUE(htk::huge_page_allocator<int>::is_huge(v.capacity()));
+    for (int i = 0; i < 2000000; i += 997)
+        EXPECT_EQ(i, v.at(i));
+    v.shrink_to_fit();
+    EXPECT_EQ(1999999, v.back());
+}
@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include <htk/bitvector.h>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    // the same bits as a plain vector<bool>, to check against.
+    std::vector<bool> random_bits(size_t count, unsigned int seed, int one_in = 2)
+    {
+        std::mt19937 gen(seed);
+        std::vector<bool> bits(count);
+        for (size_t i = 0; i < count; ++i)
+            bits[i] = gen() % one_in == 0;
+        return bits;
+    }
+
+    htk::bitvector<> to_bitvector(const std::vector<bool> &bits)
+    {
+        htk::bitvector<> v;
+        for (bool b : bits)
+            v.push_back(b);
+        return v;
+    }
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_starts_empty)
+{
+    htk::bitvector<> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0, v.count());
+    EXPECT_EQ(htk::bitvector<>::npos, v.find_first());
+    EXPECT_EQ(htk::bitvector<>::npos, v.find_first(false));
+    EXPECT_THROW(v.pop_back(), htk::exception);
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_push_back_and_test)
+{
+    const auto bits = random_bits(1000, 1);
+    const auto v = to_bitvector(bits);
+    ASSERT_EQ(1000, v.size());
+    EXPECT_EQ(16, v.word_count());
+    for (size_t i = 0; i < bits.size(); ++i)
+        EXPECT_EQ(bits[i], v.test(static_cast<htk::size_t>(i)));
+    EXPECT_THROW(v.test(1000), htk::out_of_range);
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_push_back_bits_straddles_words)
+{
+    htk::bitvector<> v;
+    v.push_back(true);
+    v.push_back_bits(0xFFFFFFFFFFFFFFFFull, 64);
+    v.push_back_bits(0x5, 3);
+    ASSERT_EQ(68, v.size());
+    EXPECT_EQ(2, v.word_count());
+    EXPECT_EQ(67, v.count());
+    EXPECT_FALSE(v.test(66));
+    EXPECT_TRUE(v.test(67));
+    EXPECT_THROW(v.push_back_bits(0, 65), htk::out_of_range);
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_set_reset_flip)
+{
+    htk::bitvector<> v(130);
+    EXPECT_EQ(0, v.count());
+    v.set(3);
+    v[129] = true;
+    v.flip(64);
+    EXPECT_EQ(3, v.count());
+    v.reset(3);
+    EXPECT_FALSE(v[3]);
+    v.set();
+    EXPECT_EQ(130, v.count());
+    EXPECT_TRUE(v.all());
+    v.reset();
+    EXPECT_TRUE(v.none());
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_resize_keeps_tail_clear)
+{
+    htk::bitvector<> v(10, true);
+    EXPECT_EQ(10, v.count());
+    v.resize(100, true);
+    EXPECT_EQ(100, v.count());
+    v.resize(70);
+    EXPECT_EQ(70, v.count());
+    v.resize(200);
+    EXPECT_EQ(70, v.count());
+    EXPECT_EQ(70, v.find_first(false));
+    v.pop_back();
+    EXPECT_EQ(199, v.size());
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_find_matches_naive)
+{
+    for (int one_in : { 2, 50, 1000 })
+    {
+        const auto bits = random_bits(5000, 7, one_in);
+        const auto v = to_bitvector(bits);
+        for (bool value : { true, false })
+        {
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < bits.size(); ++i)
+                if (bits[i] == value)
+                    expected.push_back(i);
+
+            std::vector<size_t> found;
+            for (auto pos = v.find_first(value); pos != v.npos; pos = v.find_next(pos, value))
+                found.push_back(pos);
+            EXPECT_EQ(expected, found);
+            EXPECT_EQ(expected.size(), v.count(value));
+        }
+    }
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_find_unset_ignores_tail)
+{
+    htk::bitvector<> v(65, true);
+    EXPECT_EQ(htk::bitvector<>::npos, v.find_first(false));
+    v.reset(64);
+    EXPECT_EQ(64, v.find_first(false));
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_rank_select)
+{
+    const auto bits = random_bits(3000, 3);
+    const auto v = to_bitvector(bits);
+    htk::size_t ones = 0;
+    for (htk::size_t i = 0; i < 3000; ++i)
+    {
+        EXPECT_EQ(ones, v.rank(i));
+        if (bits[i])
+        {
+            EXPECT_EQ(i, v.select(ones));
+            ++ones;
+        }
+    }
+    EXPECT_EQ(ones, v.rank(3000));
+    EXPECT_EQ(htk::bitvector<>::npos, v.select(ones));
+    EXPECT_THROW(v.rank(3001), htk::out_of_range);
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_whole_operators)
+{
+    const auto a = random_bits(1000, 11);
+    const auto b = random_bits(1000, 12);
+    auto va = to_bitvector(a);
+    const auto vb = to_bitvector(b);
+
+    auto v_and = va;
+    v_and &= vb;
+    auto v_or = va;
+    v_or |= vb;
+    auto v_xor = va;
+    v_xor ^= vb;
+    for (htk::size_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(a[i] && b[i], v_and[i]);
+        EXPECT_EQ(a[i] || b[i], v_or[i]);
+        EXPECT_EQ(a[i] != b[i], v_xor[i]);
+    }
+
+    EXPECT_THROW(va &= htk::bitvector<>(10), htk::invalid_operation);
+}
+
+TEST(htk_stl_bitvector_tests, bitvector_range_operators)
+{
+    const auto a = random_bits(700, 21);
+    const auto b = random_bits(700, 22);
+    const auto vb = to_bitvector(b);
+
+    const std::pair<htk::size_t, htk::size_t> ranges[] = { { 0, 700 }, { 3, 5 }, { 0, 64 }, { 64, 128 }, { 10, 650 }, { 63, 65 }, { 100, 100 } };
+    for (const auto &[first, last] : ranges)
+    {
+        auto v = to_bitvector(a);
+        v.bit_xor(vb, first, last);
+        for (htk::size_t i = 0; i < 700; ++i)
+        {
+            const bool inside = i >= first && i < last;
+            EXPECT_EQ(inside ? a[i] != b[i] : a[i], v[i]) << first << ".." << last << " @" << i;
+        }
+    }
+
+    auto v = to_bitvector(a);
+    EXPECT_THROW(v.bit_and(vb, 10, 701), htk::out_of_range);
+    EXPECT_THROW(v.bit_or(vb, 10, 5), htk::out_of_range);
+}
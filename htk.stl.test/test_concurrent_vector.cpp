@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include <htk/concurrent_vector.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_push_back)
+{
+    htk::concurrent_vector<int> v;
+    EXPECT_TRUE(v.empty());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, v.push_back(i));
+
+    ASSERT_EQ(1000, v.size());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, v.at(i));
+    EXPECT_THROW(v.at(1000), htk::out_of_range);
+}
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_clear_reuses_segments)
+{
+    htk::concurrent_vector<std::string> v;
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back(std::to_string(i));
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    v.emplace_back("again");
+    EXPECT_EQ(std::string("again"), v.at(0));
+}
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_threads_append)
+{
+    constexpr int threads = 8;
+    constexpr int per_thread = 10000;
+    htk::concurrent_vector<int> v;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&v, t]() {
+            for (int i = 0; i < per_thread; ++i)
+                v.push_back(t * per_thread + i);
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+
+    ASSERT_EQ(threads * per_thread, v.size());
+    std::vector<int> items(v.begin(), v.end());
+    std::sort(items.begin(), items.end());
+    for (int i = 0; i < threads * per_thread; ++i)
+        EXPECT_EQ(i, items[i]);
+}
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_read_while_appending)
+{
+    htk::concurrent_vector<std::string> v;
+    std::atomic<bool> done{ false };
+
+    std::thread reader([&v, &done]() {
+        while (!done.load())
+        {
+            const auto size = v.size();
+            for (htk::size_t i = 0; i < size; ++i)
+            {
+                // the items after the first unfinished one can be ready too.
+                if (v.ready(i))
+                {
+                    ASSERT_FALSE(v.at(i).empty());
+                }
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+    {
+        writers.emplace_back([&v]() {
+            for (int i = 0; i < 2000; ++i)
+                v.emplace_back(std::to_string(i) + " is long enough to be on the heap");
+        });
+    }
+    for (auto &w : writers)
+        w.join();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(8000, v.size());
+}
+
+namespace
+{
+    struct throws_on_negative
+    {
+        explicit throws_on_negative(int value)
+            : value(value)
+        {
+            if (value < 0)
+                throw std::runtime_error("negative");
+        }
+
+        int value;
+    };
+}
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_throwing_append_leaves_a_hole)
+{
+    htk::concurrent_vector<throws_on_negative> v;
+    v.emplace_back(0);
+    EXPECT_THROW(v.emplace_back(-1), std::runtime_error);
+    // nothing waits on the failed index.
+    EXPECT_EQ(2, v.emplace_back(2));
+
+    EXPECT_EQ(3, v.size());
+    EXPECT_TRUE(v.ready(0));
+    EXPECT_FALSE(v.ready(1));
+    EXPECT_TRUE(v.ready(2));
+    EXPECT_THROW(v.at(1), htk::invalid_operation);
+    EXPECT_EQ(2, v.at(2).value);
+
+    std::vector<int> items;
+    for (const auto &item : v)
+        items.push_back(item.value);
+    EXPECT_EQ(std::vector<int>({ 0, 2 }), items);
+
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0, v.emplace_back(5));
+    EXPECT_TRUE(v.ready(0));
+}
+
+TEST(htk_stl_concurrent_vector_tests, concurrent_vector_threads_append_past_throws)
+{
+    constexpr int threads = 4;
+    constexpr int per_thread = 5000;
+    htk::concurrent_vector<throws_on_negative> v;
+    std::atomic<int> failed{ 0 };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&v, &failed]() {
+            for (int i = 0; i < per_thread; ++i)
+            {
+                try
+                {
+                    v.emplace_back(i % 10 == 0 ? -1 : i);
+                }
+                catch (const std::runtime_error &)
+                {
+                    ++failed;
+                }
+            }
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+
+    EXPECT_EQ(threads * per_thread / 10, failed.load());
+    EXPECT_EQ(threads * per_thread, v.size());
+    int built = 0;
+    for (const auto &item : v)
+    {
+        EXPECT_NE(0, item.value % 10);
+        ++built;
+    }
+    EXPECT_EQ(threads * per_thread - failed.load(), built);
+}
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include <htk/inplace_vector.h>
+
+#include <memory>
+#include <string>
+
+namespace
+{
+    constexpr htk::inplace_vector<int, 8> make_ports()
+    {
+        htk::inplace_vector<int, 8> v;
+        v.push_back(80);
+        v.push_back(443);
+        v.emplace_back(22);
+        v.emplace(v.begin(), 21);
+        v.erase(v.begin() + 1);
+        return v;
+    }
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_is_constexpr_for_trivial_types)
+{
+    constexpr auto ports = make_ports();
+    static_assert(ports.size() == 3, "built at compile time");
+    static_assert(ports.at(0) == 21 && ports.at(1) == 443 && ports.back() == 22, "in order");
+    static_assert(ports.capacity() == 8, "fixed capacity");
+    EXPECT_EQ(21, ports.at(0));
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_has_no_heap)
+{
+    htk::inplace_vector<int, 16> v;
+    EXPECT_EQ(16 * sizeof(int) + sizeof(htk::size_t), sizeof(v));
+    const auto self = reinterpret_cast<const char *>(&v);
+    EXPECT_GE(reinterpret_cast<const char *>(v.data()), self);
+    EXPECT_LT(reinterpret_cast<const char *>(v.data()), self + sizeof(v));
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_push_back_throws_when_full)
+{
+    htk::inplace_vector<int, 3> v{ 1, 2, 3 };
+    EXPECT_TRUE(v.full());
+    EXPECT_EQ(0, v.freespace());
+    EXPECT_THROW(v.push_back(4), htk::bad_alloc);
+    EXPECT_THROW(v.reserve(4), htk::bad_alloc);
+    EXPECT_EQ(3, v.size());
+    EXPECT_EQ(3, v.back());
+    EXPECT_THROW((htk::inplace_vector<int, 2>{ 1, 2, 3 }), htk::bad_alloc);
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_try_push_back)
+{
+    htk::inplace_vector<std::string, 2> v;
+    std::string *a = v.try_push_back("a");
+    ASSERT_NE(nullptr, a);
+    EXPECT_EQ("a", *a);
+    EXPECT_NE(nullptr, v.try_emplace_back(3, 'b'));
+    EXPECT_EQ(nullptr, v.try_push_back("c"));
+    EXPECT_EQ(nullptr, v.try_emplace_back("d"));
+    EXPECT_EQ(2, v.size());
+    EXPECT_EQ("bbb", v.at(1));
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_insert_and_erase)
+{
+    htk::inplace_vector<std::string, 10> v{ "a", "d" };
+    v.emplace(v.begin() + 1, "c");
+    v.insert(v.begin() + 1, 1, std::string("b"));
+    const std::string tail[] = { "e", "f" };
+    v.insert(v.end(), tail, tail + 2);
+    v.insert(v.begin(), { "0" });
+    ASSERT_EQ(7, v.size());
+    const char *expected[] = { "0", "a", "b", "c", "d", "e", "f" };
+    for (size_t i = 0; i < 7; ++i)
+        EXPECT_EQ(expected[i], v.at(static_cast<htk::size_t>(i)));
+
+    v.erase(v.begin(), v.begin() + 2);
+    v.erase(v.end() - 1);
+    ASSERT_EQ(4, v.size());
+    EXPECT_EQ("b", v.at(0));
+    EXPECT_EQ("e", v.back());
+
+    const std::string too_many[] = { "1", "2", "3", "4", "5", "6", "7" };
+    EXPECT_THROW(v.insert(v.begin(), too_many, too_many + 7), htk::bad_alloc);
+    EXPECT_EQ(4, v.size());
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_resize)
+{
+    htk::inplace_vector<int, 8> v;
+    v.resize(4, 7);
+    EXPECT_EQ(4, v.size());
+    EXPECT_EQ(7, v.back());
+    v.resize(6);
+    EXPECT_EQ(0, v.back());
+    v.resize(2);
+    EXPECT_EQ(2, v.size());
+    EXPECT_THROW(v.resize(9), htk::bad_alloc);
+    v.pop_back();
+    v.pop_back();
+    EXPECT_THROW(v.pop_back(), htk::exception);
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_destroys_items)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        htk::inplace_vector<std::shared_ptr<int>, 4> v;
+        v.push_back(counter);
+        v.push_back(counter);
+        EXPECT_EQ(3, counter.use_count());
+
+        auto copy = v;
+        EXPECT_EQ(5, counter.use_count());
+        auto moved = htk::move(copy);
+        EXPECT_EQ(5, counter.use_count());
+        copy = v;
+        EXPECT_EQ(7, counter.use_count());
+        v.pop_back();
+        EXPECT_EQ(6, counter.use_count());
+    }
+    EXPECT_EQ(1, counter.use_count());
+}
+
+TEST(htk_stl_inplace_vector_tests, inplace_vector_erase_if)
+{
+    htk::inplace_vector<int, 10> v{ 1, 2, 3, 4, 5, 6 };
+    EXPECT_EQ(3, htk::erase_if(v, [](int i) { return i % 2 == 0; }));
+    EXPECT_EQ(1, htk::erase(v, 3));
+    ASSERT_EQ(2, v.size());
+    EXPECT_EQ(1, v.at(0));
+    EXPECT_EQ(5, v.at(1));
+}
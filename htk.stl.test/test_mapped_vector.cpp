@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+#include <htk/mapped_vector.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // a file name for the test, that's gone again when it ends.
+    struct temp_file
+    {
+        temp_file(const char *name)
+            : path(name)
+        {
+            std::remove(path);
+        }
+
+        ~temp_file()
+        {
+            std::remove(path);
+        }
+
+        long long size() const
+        {
+            std::ifstream f(path, std::ios::binary | std::ios::ate);
+            return static_cast<long long>(f.tellg());
+        }
+
+        const char *path;
+    };
+
+    struct point
+    {
+        int x;
+        int y;
+    };
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_starts_empty)
+{
+    temp_file file("htk_mapped_vector_empty.bin");
+    htk::mapped_vector<int> v(file.path);
+
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0, v.capacity());
+    EXPECT_FALSE(v.read_only());
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_push_back_grows_file)
+{
+    temp_file file("htk_mapped_vector_grow.bin");
+    {
+        htk::mapped_vector<int> v(file.path);
+        for (int i = 0; i < 10000; ++i)
+            v.push_back(i);
+
+        EXPECT_EQ(10000, v.size());
+        EXPECT_GE(v.capacity(), v.size());
+        for (int i = 0; i < 10000; ++i)
+            EXPECT_EQ(i, v.at(i));
+    }
+    // the slack is cut off when it closes.
+    EXPECT_EQ(10000 * sizeof(int), file.size());
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_reopens)
+{
+    temp_file file("htk_mapped_vector_reopen.bin");
+    {
+        htk::mapped_vector<point> v(file.path);
+        for (int i = 0; i < 100; ++i)
+            v.emplace_back(point{ i, -i });
+    }
+    {
+        htk::mapped_vector<point> v(file.path);
+        ASSERT_EQ(100, v.size());
+        EXPECT_EQ(42, v.at(42).x);
+        EXPECT_EQ(-99, v.back().y);
+        v.push_back(point{ 100, -100 });
+    }
+    htk::mapped_vector<point> v(file.path, htk::map_mode::read_only);
+    EXPECT_EQ(101, v.size());
+    EXPECT_EQ(100, v.back().x);
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_read_only_throws_on_modify)
+{
+    temp_file file("htk_mapped_vector_read_only.bin");
+    {
+        htk::mapped_vector<int> v(file.path);
+        v.push_back(1);
+    }
+    htk::mapped_vector<int> v(file.path, htk::map_mode::read_only);
+    EXPECT_TRUE(v.read_only());
+    EXPECT_THROW(v.push_back(2), htk::invalid_operation);
+    EXPECT_THROW(v.clear(), htk::invalid_operation);
+    EXPECT_EQ(1, v.at(0));
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_read_only_missing_file_throws)
+{
+    EXPECT_THROW(htk::mapped_vector<int>("htk_mapped_vector_does_not_exist.bin", htk::map_mode::read_only), htk::exception);
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_sorts_and_searches)
+{
+    temp_file file("htk_mapped_vector_sort.bin");
+    htk::mapped_vector<int> v(file.path);
+    const int items[] = { 5, 3, 9, 1, 7 };
+    v.append(std::begin(items), std::end(items));
+
+    std::sort(v.begin(), v.end());
+
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_TRUE(std::binary_search(v.begin(), v.end(), 7));
+    EXPECT_EQ(9, v.back());
+}
+
+TEST(htk_stl_mapped_vector_tests, mapped_vector_resize_reserve_shrink)
+{
+    temp_file file("htk_mapped_vector_resize.bin");
+    htk::mapped_vector<int> v(file.path);
+    v.resize(10, 4);
+    EXPECT_EQ(10, v.size());
+    EXPECT_EQ(4, v.at(9));
+
+    v.reserve(1000);
+    EXPECT_EQ(1000, v.capacity());
+    EXPECT_EQ(4, v.at(0));
+
+    v.shrink_to_fit();
+    EXPECT_EQ(10, v.capacity());
+    EXPECT_EQ(4, v.at(9));
+
+    v.pop_back();
+    v.resize(2);
+    EXPECT_EQ(2, v.size());
+    v.clear();
+    EXPECT_TRUE(v.empty());
+}
+
+#ifndef _WIN32
+TEST(htk_stl_mapped_vector_tests, mapped_vector_failed_growth_keeps_items)
+{
+    temp_file file("htk_mapped_vector_failed_growth.bin");
+    htk::mapped_vector<int> v(file.path);
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(i);
+
+    // a file size limit makes growing the file fail, the way a full disk would.
+    rlimit old_limit;
+    ASSERT_EQ(0, ::getrlimit(RLIMIT_FSIZE, &old_limit));
+    const auto old_handler = ::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit = old_limit;
+    limit.rlim_cur = 1024 * 1024;
+    ASSERT_EQ(0, ::setrlimit(RLIMIT_FSIZE, &limit));
+    EXPECT_THROW(v.reserve(10000000), htk::exception);
+    ::setrlimit(RLIMIT_FSIZE, &old_limit);
+    ::signal(SIGXFSZ, old_handler);
+
+    ASSERT_EQ(1000, v.size());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, v.at(i));
+    v.push_back(1000);
+    EXPECT_EQ(1000, v.back());
+}
+#endif
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+#include <htk/radix_sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+    // a spread of values over the whole range of T, some of them repeated.
+    template <typename T>
+    std::vector<T> scattered(size_t size)
+    {
+        std::vector<T> v;
+        uint64_t x = 88172645463325252ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            T value;
+            memcpy(&value, &x, sizeof(T));
+            v.push_back(i % 5 == 0 && i > 0 ? v[i / 2] : value);
+        }
+        return v;
+    }
+
+    template <typename T>
+    void expect_sorts_like_std(std::vector<T> v)
+    {
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+        htk::radix_sort(v.begin(), v.end());
+        EXPECT_EQ(expected, v);
+    }
+
+    struct record
+    {
+        int64_t key;
+        int order;
+    };
+}
+
+TEST(htk_radix_sort_tests, radix_sort_integers_match_std)
+{
+    for (size_t size : { 0, 1, 2, 64, 65, 1000, 100000 })
+    {
+        expect_sorts_like_std(scattered<uint32_t>(size));
+        expect_sorts_like_std(scattered<int32_t>(size));
+        expect_sorts_like_std(scattered<uint64_t>(size));
+        expect_sorts_like_std(scattered<int64_t>(size));
+        expect_sorts_like_std(scattered<int16_t>(size));
+        expect_sorts_like_std(scattered<uint8_t>(size));
+    }
+}
+
+TEST(htk_radix_sort_tests, radix_sort_signed_extremes)
+{
+    std::vector<int> v;
+    for (int i = 0; i < 100; ++i)
+    {
+        v.push_back(std::numeric_limits<int>::max() - i);
+        v.push_back(std::numeric_limits<int>::min() + i);
+        v.push_back(i - 50);
+    }
+    expect_sorts_like_std(v);
+}
+
+TEST(htk_radix_sort_tests, radix_sort_floats_match_std)
+{
+    std::vector<float> f;
+    std::vector<double> d;
+    for (int i = 0; i < 1000; ++i)
+    {
+        f.push_back((i * 7919 % 2001 - 1000) / 7.0f);
+        d.push_back((i * 7919 % 2001 - 1000) * 1e100);
+    }
+    f.push_back(std::numeric_limits<float>::infinity());
+    f.push_back(-std::numeric_limits<float>::infinity());
+    f.push_back(std::numeric_limits<float>::denorm_min());
+    d.push_back(-std::numeric_limits<double>::max());
+    d.push_back(-std::numeric_limits<double>::denorm_min());
+    expect_sorts_like_std(f);
+    expect_sorts_like_std(d);
+}
+
+TEST(htk_radix_sort_tests, radix_sort_negative_zero_first)
+{
+    std::vector<double> v(100, 0.0);
+    v[50] = -0.0;
+    v[99] = -1.0;
+    htk::radix_sort(v.begin(), v.end());
+    EXPECT_EQ(-1.0, v[0]);
+    EXPECT_TRUE(std::signbit(v[1]));
+    EXPECT_FALSE(std::signbit(v[2]));
+}
+
+TEST(htk_radix_sort_tests, radix_sort_by_key_is_stable)
+{
+    std::vector<record> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back({ int64_t(i * 7919 % 37) - 18, i });
+
+    htk::radix_sort(v.begin(), v.end(), [](const record &r) { return r.key; });
+    for (size_t i = 1; i < v.size(); ++i)
+    {
+        ASSERT_LE(v[i - 1].key, v[i].key);
+        if (v[i - 1].key == v[i].key)
+        {
+            EXPECT_LT(v[i - 1].order, v[i].order);
+        }
+    }
+}
+
+TEST(htk_radix_sort_tests, radix_sort_reuses_scratch)
+{
+    htk::vector<uint32_t> scratch;
+    auto v = scattered<uint32_t>(1000);
+    htk::radix_sort(v.begin(), v.end(), scratch);
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    const uint32_t *buffer = scratch.data();
+    ASSERT_EQ(1000, scratch.size());
+
+    // a smaller sort deals into the same buffer.
+    v = scattered<uint32_t>(500);
+    htk::radix_sort(v.begin(), v.end(), scratch);
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_EQ(buffer, scratch.data());
+}
+
+TEST(htk_radix_sort_tests, radix_sort_ping_pong_returns_sorted_buffer)
+{
+    // every key fits in the first digit, so one pass, into scratch.
+    std::vector<uint32_t> data, scratch(1000);
+    for (uint32_t i = 0; i < 1000; ++i)
+        data.push_back(i * 7919 % 2048);
+    const uint32_t *sorted = htk::radix_sort_ping_pong(data.data(), scratch.data(), data.size());
+    EXPECT_EQ(scratch.data(), sorted);
+    EXPECT_TRUE(std::is_sorted(sorted, sorted + 1000));
+
+    // two passes land back in data.
+    for (uint32_t i = 0; i < 1000; ++i)
+        data[i] = i * 7919 % 4000000;
+    sorted = htk::radix_sort_ping_pong(data.data(), scratch.data(), data.size());
+    EXPECT_EQ(data.data(), sorted);
+    EXPECT_TRUE(std::is_sorted(sorted, sorted + 1000));
+}
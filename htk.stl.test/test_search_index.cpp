@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include <htk/search_index.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+    std::vector<int> sorted_keys(size_t size)
+    {
+        std::vector<int> keys;
+        for (size_t i = 0; i < size; ++i)
+            keys.push_back(static_cast<int>((i * 7919) % (size * 2 + 1)));
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    // what the index found, as a value, against what lower_bound finds.
+    template <typename IndexT>
+    void expect_lower_bound_matches_std(size_t size)
+    {
+        const auto keys = sorted_keys(size);
+        const IndexT index(keys);
+        ASSERT_EQ(keys.size(), index.size());
+
+        for (int x = -1; x <= static_cast<int>(size * 2 + 2); ++x)
+        {
+            const auto expected = std::lower_bound(keys.begin(), keys.end(), x);
+            const auto found = index.lower_bound(x);
+            if (expected == keys.end())
+                EXPECT_EQ(nullptr, found) << size << " " << x;
+            else
+            {
+                ASSERT_NE(nullptr, found) << size << " " << x;
+                EXPECT_EQ(*expected, *found) << size << " " << x;
+            }
+            EXPECT_EQ(std::binary_search(keys.begin(), keys.end(), x), index.contains(x));
+        }
+    }
+}
+
+TEST(htk_stl_search_index_tests, eytzinger_index_empty)
+{
+    const htk::eytzinger_index<int> index;
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(nullptr, index.lower_bound(1));
+    EXPECT_FALSE(index.contains(0));
+}
+
+TEST(htk_stl_search_index_tests, eytzinger_index_matches_lower_bound)
+{
+    for (size_t size : { 1, 2, 3, 15, 16, 17, 100, 1000, 4097 })
+        expect_lower_bound_matches_std<htk::eytzinger_index<int>>(size);
+}
+
+TEST(htk_stl_search_index_tests, eytzinger_index_upper_bound_and_duplicates)
+{
+    const htk::vector<int> keys{ 1, 3, 3, 3, 7, 9 };
+    const htk::eytzinger_index<int> index(keys);
+    EXPECT_EQ(3, *index.lower_bound(2));
+    EXPECT_EQ(3, *index.lower_bound(3));
+    EXPECT_EQ(7, *index.upper_bound(3));
+    EXPECT_EQ(nullptr, index.upper_bound(9));
+    EXPECT_EQ(nullptr, index.find(4));
+    EXPECT_EQ(9, *index.find(9));
+}
+
+TEST(htk_stl_search_index_tests, s_tree_index_empty)
+{
+    const htk::s_tree_index<int> index;
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(nullptr, index.lower_bound(1));
+}
+
+TEST(htk_stl_search_index_tests, s_tree_index_matches_lower_bound)
+{
+    for (size_t size : { 1, 2, 15, 16, 17, 272, 273, 1000, 5000 })
+        expect_lower_bound_matches_std<htk::s_tree_index<int>>(size);
+}
+
+TEST(htk_stl_search_index_tests, s_tree_index_keys_at_the_limit)
+{
+    // the padding is max() too, it mustn't be mistaken for a key.
+    const int max = std::numeric_limits<int>::max();
+    const std::vector<int> keys{ -5, 0, 10, max };
+    const htk::s_tree_index<int> index(keys);
+    EXPECT_EQ(max, *index.lower_bound(11));
+    EXPECT_TRUE(index.contains(max));
+    EXPECT_FALSE(index.contains(max - 1));
+
+    const std::vector<int> small{ 1, 2 };
+    const htk::s_tree_index<int> short_index(small);
+    EXPECT_EQ(nullptr, short_index.lower_bound(3));
+    EXPECT_EQ(nullptr, short_index.lower_bound(max));
+}
+
+TEST(htk_stl_search_index_tests, s_tree_index_other_key_types)
+{
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 1000; ++i)
+        keys.push_back(i * 3);
+    const htk::s_tree_index<uint64_t> index(keys);
+    EXPECT_EQ(9u, *index.lower_bound(7));
+    EXPECT_TRUE(index.contains(2997));
+    EXPECT_FALSE(index.contains(2998));
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include <htk/small_vector.h>
+
+#include <string>
+
+TEST(htk_stl_small_vector_tests, small_vector_starts_inline)
+{
+    htk::small_vector<int, 16> v;
+    EXPECT_EQ(0, v.size());
+    EXPECT_EQ(16, v.capacity());
+    EXPECT_TRUE(v.is_inline());
+}
+
+TEST(htk_stl_small_vector_tests, small_vector_emplace_to_inline_capacity)
+{
+    htk::small_vector<int, 4> v;
+    for (int i = 0; i < 4; ++i)
+        v.emplace_back(i);
+
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(4, v.capacity());
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(i, v.at(i));
+}
+
+TEST(htk_stl_small_vector_tests, small_vector_spills_past_inline_capacity)
+{
+    htk::small_vector<int, 4> v;
+    for (int i = 0; i < 5; ++i)
+        v.emplace_back(i);
+
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_LT(4, v.capacity());
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(i, v.at(i));
+}
+
+TEST(htk_stl_small_vector_tests, small_vector_insert_inline)
+{
+    htk::small_vector<int, 8> v{ 1, 2, 6 };
+    htk::vector<int> v2{ 3, 4, 5 };
+
+    v.insert(v.begin() + 2, v2.begin(), v2.end());
+
+    EXPECT_TRUE(v.is_inline());
+    ASSERT_EQ(6, v.size());
+    for (int i = 0; i < 6; ++i)
+        EXPECT_EQ(i + 1, v.at(i));
+}
+
+TEST(htk_stl_small_vector_tests, small_vector_move_inline)
+{
+    htk::small_vector<std::string, 4> v;
+    v.emplace_back("one");
+    v.emplace_back("two");
+
+    htk::small_vector<std::string, 4> moved(std::move(v));
+
+    EXPECT_TRUE(moved.is_inline());
+    EXPECT_TRUE(v.empty());
+    ASSERT_EQ(2, moved.size());
+    EXPECT_EQ("one", moved.at(0));
+    EXPECT_EQ("two", moved.at(1));
+}
+
+TEST(htk_stl_small_vector_tests, small_vector_move_heap)
+{
+    htk::small_vector<std::string, 2> v;
+    v.emplace_back("one");
+    v.emplace_back("two");
+    v.emplace_back("three");
+    const auto first = &v.at(0);
+
+    htk::small_vector<std::string, 2> moved(std::move(v));
+
+    EXPECT_FALSE(moved.is_inline());
+    EXPECT_EQ(first, &moved.at(0));
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ("three", moved.at(2));
+}
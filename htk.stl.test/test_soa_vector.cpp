@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include <htk/soa_vector.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+
+TEST(htk_stl_soa_vector_tests, soa_vector_starts_empty)
+{
+    htk::soa_vector<int, float> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0, v.size());
+    EXPECT_TRUE(v.column<0>().empty());
+    EXPECT_THROW(v.pop_back(), htk::exception);
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_emplace_back_fills_every_column)
+{
+    htk::soa_vector<int, double, std::string> v;
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back(i, i * 0.5, std::to_string(i));
+
+    ASSERT_EQ(100, v.size());
+    auto ids = v.column<0>();
+    auto weights = v.column<1>();
+    auto names = v.column<2>();
+    ASSERT_EQ(100, ids.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, ids[i]);
+        EXPECT_EQ(i * 0.5, weights[i]);
+        EXPECT_EQ(std::to_string(i), names[i]);
+    }
+    EXPECT_THROW(v.at(100), htk::out_of_range);
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_columns_are_aligned)
+{
+    htk::soa_vector<char, int16_t, double> v;
+    for (int i = 0; i < 10; ++i)
+        v.emplace_back(char(i), int16_t(i), double(i));
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(v.column<0>().data()) % htk::cache_line_size);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(v.column<1>().data()) % htk::cache_line_size);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(v.column<2>().data()) % htk::cache_line_size);
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_proxy_writes_through)
+{
+    htk::soa_vector<int, float> v;
+    v.emplace_back(1, 1.0f);
+    v.push_back(std::make_tuple(2, 2.0f));
+
+    for (auto [id, weight] : v)
+    {
+        id *= 10;
+        weight += 0.5f;
+    }
+
+    EXPECT_EQ(10, v.column<0>()[0]);
+    EXPECT_EQ(20, v.column<0>()[1]);
+    EXPECT_EQ(1.5f, std::get<1>(v.at(0)));
+    EXPECT_EQ(2.5f, std::get<1>(v[1]));
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_column_scan)
+{
+    htk::soa_vector<int, int> v;
+    v.reserve(1000);
+    EXPECT_GE(v.capacity(), 1000);
+    for (int i = 0; i < 1000; ++i)
+        v.emplace_back(i, -i);
+
+    auto xs = v.column<0>();
+    EXPECT_EQ(499500, std::accumulate(xs.begin(), xs.end(), 0));
+    EXPECT_EQ(-499500, std::accumulate(v.column<1>().begin(), v.column<1>().end(), 0));
+    EXPECT_EQ(10, xs.subspan(10, 5).front());
+    EXPECT_THROW(xs.subspan(999, 2), htk::out_of_range);
+}
+
+TEST(htk_stl_soa_vector_tests, span_bounds_dont_wrap)
+{
+    int a[3] = { 1, 2, 3 };
+    htk::span<int> s(a, 3);
+    EXPECT_EQ(3, s.last(1).front());
+    EXPECT_EQ(3, s.last(3).size());
+    EXPECT_TRUE(s.subspan(3, 0).empty());
+    EXPECT_THROW(s.last(5), htk::out_of_range);
+    EXPECT_THROW(s.subspan(1, 0xFFFFFFFF), htk::out_of_range);
+    EXPECT_THROW(s.subspan(4, 0xFFFFFFFF), htk::out_of_range);
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_pop_back_and_clear)
+{
+    htk::soa_vector<std::string, int> v;
+    v.emplace_back("a", 1);
+    v.emplace_back("b", 2);
+    v.pop_back();
+    ASSERT_EQ(1, v.size());
+    EXPECT_EQ(1, v.column<1>().size());
+    EXPECT_EQ("a", std::get<0>(v.at(0)));
+
+    v.clear();
+    EXPECT_TRUE(v.empty());
+    EXPECT_TRUE(v.column<1>().empty());
+}
+
+namespace
+{
+    struct throws_on_copy
+    {
+        explicit throws_on_copy(bool armed = false)
+            : armed(armed)
+        {
+        }
+
+        throws_on_copy(const throws_on_copy &rhs)
+            : armed(false)
+        {
+            if (rhs.armed)
+                throw std::runtime_error("no copies");
+        }
+
+        bool armed;
+    };
+}
+
+TEST(htk_stl_soa_vector_tests, soa_vector_emplace_back_rolls_back)
+{
+    htk::soa_vector<int, std::string, throws_on_copy> v;
+    v.emplace_back(1, "one", throws_on_copy{});
+    const throws_on_copy bad(true);
+    EXPECT_THROW(v.emplace_back(2, "two", bad), std::runtime_error);
+
+    // the columns that took the row gave it back.
+    ASSERT_EQ(1, v.size());
+    EXPECT_EQ(1, v.column<0>().size());
+    EXPECT_EQ(1, v.column<1>().size());
+    EXPECT_EQ("one", v.column<1>()[0]);
+}
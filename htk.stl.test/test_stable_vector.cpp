@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include <htk/stable_vector.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(htk_stl_stable_vector_tests, stable_vector_starts_empty)
+{
+    htk::stable_vector<int> v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0, v.capacity());
+    EXPECT_EQ(0, v.segments());
+}
+
+TEST(htk_stl_stable_vector_tests, stable_vector_segments_double)
+{
+    htk::stable_vector<int, htk::allocator<int>, 4> v;
+    v.push_back(0);
+    EXPECT_EQ(4, v.capacity());
+    v.reserve(5);
+    EXPECT_EQ(12, v.capacity());
+    v.reserve(13);
+    EXPECT_EQ(28, v.capacity());
+    EXPECT_EQ(3, v.segments());
+}
+
+TEST(htk_stl_stable_vector_tests, stable_vector_indexes_across_segments)
+{
+    htk::stable_vector<int, htk::allocator<int>, 4> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(i);
+
+    ASSERT_EQ(1000, v.size());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, v.at(i));
+    EXPECT_EQ(999, v.back());
+    EXPECT_THROW(v.at(1000), htk::out_of_range);
+}
+
+TEST(htk_stl_stable_vector_tests, stable_vector_addresses_are_stable)
+{
+    htk::stable_vector<std::string> v;
+    std::vector<const std::string *> addresses;
+    for (int i = 0; i < 5000; ++i)
+        addresses.push_back(&v.emplace_back(std::to_string(i)));
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        EXPECT_EQ(addresses[i], &v.at(i));
+        EXPECT_EQ(std::to_string(i), *addresses[i]);
+    }
+}
+
+TEST(htk_stl_stable_vector_tests, stable_vector_destroys_items)
+{
+    auto counter = std::make_shared<int>(0);
+    {
+        htk::stable_vector<std::shared_ptr<int>> v;
+        for (int i = 0; i < 100; ++i)
+            v.push_back(counter);
+        EXPECT_EQ(101, counter.use_count());
+        v.pop_back();
+        EXPECT_EQ(100, counter.use_count());
+        v.clear();
+        EXPECT_EQ(1, counter.use_count());
+        EXPECT_GT(v.capacity(), 0);
+        v.push_back(counter);
+    }
+    EXPECT_EQ(1, counter.use_count());
+}
+
+TEST(htk_stl_stable_vector_tests, stable_vector_sort)
+{
+    htk::stable_vector<int> v{ 5, 3, 9, 1, 7 };
+    for (int i = 0; i < 100; ++i)
+        v.push_back(100 - i);
+
+    std::sort(v.begin(), v.end());
+
+    EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+    EXPECT_EQ(105, v.end() - v.begin());
+    EXPECT_EQ(1, *v.begin());
+    EXPECT_EQ(100, v.back());
+}
@@ -4,6 +4,12 @@
 #include <htk/vector.h>
 
 #include <array>
+#include <forward_list>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 
 struct test_obj
@@ -100,6 +106,87 @@ struct copyable : public test_obj
     copyable(copyable&&) = delete;
 };
 
+// owns a pointer, and says it can be relocated with a memcpy.
+struct relocatable : public test_obj
+{
+    relocatable(int value)
+        :test_obj(value), owned(new int(value))
+    {
+    }
+    relocatable(const relocatable&) = delete;
+    relocatable(relocatable&& r) noexcept
+        :test_obj(std::move(r)), owned(std::move(r.owned))
+    {
+    }
+
+    std::unique_ptr<int> owned;
+};
+
+template <>
+struct htk::is_trivially_relocatable<relocatable> : htk::true_type {};
+
+// copying throws once copies_left runs out, live counts what's alive.
+struct throws_on_copy
+{
+    static int copies_left;
+    static int live;
+
+    int value;
+
+    throws_on_copy(int value)
+        :value(value)
+    {
+        ++live;
+    }
+    throws_on_copy(const throws_on_copy &rhs)
+        :value(rhs.value)
+    {
+        if (copies_left-- == 0)
+            throw std::runtime_error("no more copies");
+        ++live;
+    }
+    throws_on_copy(throws_on_copy &&rhs) noexcept
+        :value(rhs.value)
+    {
+        ++live;
+    }
+    throws_on_copy &operator=(const throws_on_copy &) = default;
+    throws_on_copy &operator=(throws_on_copy &&) = default;
+    ~throws_on_copy()
+    {
+        --live;
+    }
+};
+
+int throws_on_copy::copies_left = 0;
+int throws_on_copy::live = 0;
+
+// a stateful allocator, two of them are only equal when their ids match.
+template <typename T, bool Propagate>
+struct tagged_allocator : htk::allocator<T>
+{
+    using propagate_on_container_copy_assignment = htk::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = htk::bool_constant<Propagate>;
+
+    tagged_allocator(int id = 0)
+        :id(id)
+    {
+    }
+
+    tagged_allocator select_on_container_copy_construction() const
+    {
+        return tagged_allocator(id + 100);
+    }
+
+    int id;
+};
+
+template <typename T, bool Propagate>
+bool operator==(const tagged_allocator<T, Propagate> &l, const tagged_allocator<T, Propagate> &r) { return l.id == r.id; }
+
+template <typename T, bool Propagate>
+bool operator!=(const tagged_allocator<T, Propagate> &l, const tagged_allocator<T, Propagate> &r) { return l.id != r.id; }
+
 unsigned int test_obj::constructors = 0;
 unsigned int test_obj::destructors = 0;
 unsigned int test_obj::copies = 0;
@@ -426,6 +513,558 @@ TEST(htk_stl_vector_tests, vector_pod_insert_range_middle_no_capacity)
     expect_eq_rg({ 1,2,3, 40, 50, 4,5,6, 60, 70, 80, 90, 100 }, v);
 }
 
+TEST(htk_stl_vector_tests, vector_insert_range_input_iterator_end)
+{
+    htk::vector<int> v{ 1, 2 };
+    std::istringstream in("3 4 5 6 7 8 9 10 11 12");
+
+    v.insert(v.end(), std::istream_iterator<int>(in), std::istream_iterator<int>());
+
+    expect_eq_rg({ 1,2,3,4,5,6,7,8,9,10,11,12 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_insert_range_input_iterator_middle)
+{
+    htk::vector<int> v{ 1, 5, 6 };
+    std::istringstream in("2 3 4");
+
+    auto it = v.insert(v.begin() + 1, std::istream_iterator<int>(in), std::istream_iterator<int>());
+
+    EXPECT_EQ(2, *it);
+    expect_eq_rg({ 1,2,3,4,5,6 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_insert_range_forward_iterator_one_allocation)
+{
+    using vector = htk::vector<int, htk::allocator<int>, htk::exact_growth<4>>;
+    vector v;
+    v.emplace_back(1);
+    v.emplace_back(5);
+    std::forward_list<int> l{ 2, 3, 4 };
+
+    v.insert(v.begin() + 1, l.begin(), l.end());
+
+    EXPECT_EQ(5, v.capacity());
+    expect_eq_rg({ 1,2,3,4,5 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_class_insert_range_pointers)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(4) };
+    const test_obj items[] = { test_obj(2), test_obj(3) };
+
+    v.insert(v.begin() + 1, std::begin(items), std::end(items));
+
+    expect_eq_rg({ test_obj(1),test_obj(2),test_obj(3),test_obj(4) }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_append_range)
+{
+    htk::vector<int> v{ 1, 2 };
+    htk::vector<int> v2{ 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    std::forward_list<int> l{ 12, 13 };
+
+    v.append_range(v2);
+    v.append_range(l);
+
+    expect_eq_rg({ 1,2,3,4,5,6,7,8,9,10,11,12,13 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_insert_initializer_list)
+{
+    htk::vector<int> v{ 1, 4 };
+    v.insert(v.begin() + 1, { 2, 3 });
+
+    expect_eq_rg({ 1,2,3,4 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_emplace_middle)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(3) };
+
+    auto it = v.emplace(v.begin() + 1, 2);
+
+    EXPECT_EQ(2, it->value_);
+    expect_eq_rg({ test_obj(1),test_obj(2),test_obj(3) }, v);
+}
+
+// growth
+TEST(htk_stl_vector_tests, vector_exact_growth)
+{
+    using vector = htk::vector<int, htk::allocator<int>, htk::exact_growth<4>>;
+    vector v;
+    for (int i = 0; i < 6; ++i)
+        v.emplace_back(i);
+
+    EXPECT_EQ(4, vector::initial_capacity);
+    EXPECT_EQ(6, v.capacity());
+    expect_eq_rg({ 0,1,2,3,4,5 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_one_and_half_growth)
+{
+    using vector = htk::vector<int, htk::allocator<int>, htk::one_and_half_growth<10>>;
+    vector v;
+    for (int i = 0; i < 11; ++i)
+        v.emplace_back(i);
+
+    EXPECT_EQ(15, v.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_page_growth)
+{
+    using vector = htk::vector<int, htk::allocator<int>, htk::page_growth<10>>;
+    vector v;
+    for (int i = 0; i < 11; ++i)
+        v.emplace_back(i);
+
+    EXPECT_EQ(1024, v.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_pod_grows_in_place_keeps_items)
+{
+    htk::vector<int> v;
+    for (int i = 0; i < 100000; ++i)
+        v.emplace_back(i);
+
+    ASSERT_EQ(100000, v.size());
+    for (int i = 0; i < 100000; ++i)
+        ASSERT_EQ(i, v.at(i));
+}
+
+TEST(htk_stl_vector_tests, vector_pod_insert_value_end_no_capacity)
+{
+    htk::vector<int> v{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    v.insert(v.end(), 3, 11);
+
+    EXPECT_LT(htk::vector<int>::initial_capacity, v.capacity());
+    expect_eq_rg({ 1,2,3,4,5,6,7,8,9,10,11,11,11 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_relocatable_memcpy_at_expand)
+{
+    test_obj::reset();
+    {
+        using vector = htk::vector<relocatable>;
+        vector v;
+        for (int i = 0; i < vector::initial_capacity * 4; ++i)
+            v.emplace_back(i);
+
+        EXPECT_EQ(0, test_obj::moves);
+        EXPECT_EQ(0, test_obj::destructors);
+        for (int i = 0; i < vector::initial_capacity * 4; ++i)
+            EXPECT_EQ(i, *v.at(i).owned);
+    }
+    EXPECT_EQ(htk::vector<relocatable>::initial_capacity * 4, test_obj::destructors);
+}
+
+TEST(htk_stl_vector_tests, vector_relocatable_insert_middle)
+{
+    htk::vector<relocatable> v;
+    v.emplace_back(1);
+    v.emplace_back(4);
+    htk::vector<relocatable> v2;
+    v2.emplace_back(2);
+    v2.emplace_back(3);
+
+    v.insert(v.begin() + 1, std::make_move_iterator(v2.begin()), std::make_move_iterator(v2.end()));
+
+    ASSERT_EQ(4, v.size());
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(i + 1, *v.at(i).owned);
+}
+
+TEST(htk_stl_vector_tests, vector_class_insert_value_multi_middle_no_capacity)
+{
+    test_obj::reset();
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(6), test_obj(7), test_obj(8), test_obj(9), test_obj(10), test_obj(11), test_obj(12), test_obj(13) };
+
+    v.insert(v.begin() + 2, 3, test_obj(3));
+
+    EXPECT_LT(htk::vector<test_obj>::initial_capacity, v.capacity());
+    expect_eq_rg({ test_obj(1),test_obj(2),test_obj(3),test_obj(3),test_obj(3),test_obj(6),test_obj(7),test_obj(8),test_obj(9),test_obj(10),test_obj(11),test_obj(12),test_obj(13) }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_class_insert_value_many_middle_has_capacity)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(6) };
+
+    v.insert(v.begin() + 2, 3, test_obj(3));
+
+    EXPECT_EQ(htk::vector<test_obj>::initial_capacity, v.capacity());
+    expect_eq_rg({ test_obj(1),test_obj(2),test_obj(3),test_obj(3),test_obj(3),test_obj(6) }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_throwing_insert_closes_the_gap)
+{
+    const auto values = [](const htk::vector<throws_on_copy> &v) {
+        std::vector<int> out;
+        for (size_t i = 0; i < v.size(); ++i)
+            out.push_back(v.at(i).value);
+        return out;
+    };
+    const std::vector<int> expected{ 1, 2, 3, 4, 5 };
+    throws_on_copy::copies_left = 3;
+    const std::vector<throws_on_copy> source{ 7, 8, 9 };
+    const int outside = throws_on_copy::live;
+
+    // a copy into the gap throws partway, in place and with a regrow.
+    for (size_t spare : { size_t(8), size_t(0) })
+    {
+        htk::vector<throws_on_copy> v;
+        v.reserve(5 + spare);
+        for (int i = 1; i <= 5; ++i)
+            v.emplace_back(i);
+
+        throws_on_copy::copies_left = 2;
+        EXPECT_THROW(v.insert(v.begin() + 2, 3, throws_on_copy(6)), std::runtime_error);
+        EXPECT_EQ(expected, values(v));
+        EXPECT_EQ(outside + 5, throws_on_copy::live);
+
+        throws_on_copy::copies_left = 2;
+        EXPECT_THROW(v.insert(v.begin() + 1, source.begin(), source.end()), std::runtime_error);
+        EXPECT_EQ(expected, values(v));
+        EXPECT_EQ(outside + 5, throws_on_copy::live);
+    }
+    EXPECT_EQ(outside, throws_on_copy::live);
+}
+
+// capacity
+TEST(htk_stl_vector_tests, vector_reserve_empty)
+{
+    htk::vector<int> v;
+    v.reserve(1000);
+
+    EXPECT_EQ(1000, v.capacity());
+    EXPECT_EQ(0, v.size());
+}
+
+TEST(htk_stl_vector_tests, vector_reserve_keeps_items)
+{
+    htk::vector<int> v{ 1, 2, 3 };
+    v.reserve(1000);
+
+    EXPECT_EQ(1000, v.capacity());
+    expect_eq_rg({ 1,2,3 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_reserve_smaller_is_noop)
+{
+    htk::vector<int> v;
+    v.reserve(100);
+    v.reserve(10);
+
+    EXPECT_EQ(100, v.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_resize_grow_value_initializes)
+{
+    htk::vector<int> v{ 1, 2 };
+    v.resize(5);
+
+    expect_eq_rg({ 1,2,0,0,0 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_resize_grow_with_value)
+{
+    htk::vector<int> v{ 1, 2 };
+    v.resize(4, 7);
+
+    expect_eq_rg({ 1,2,7,7 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_resize_shrink_destroys)
+{
+    test_obj::reset();
+    htk::vector<test_obj> v;
+    for (int i = 0; i < 5; ++i)
+        v.emplace_back();
+
+    v.resize(2);
+
+    EXPECT_EQ(2, v.size());
+    EXPECT_EQ(3, test_obj::destructors);
+}
+
+TEST(htk_stl_vector_tests, vector_resize_default_init)
+{
+    htk::vector<uint8_t> v;
+    v.resize_default_init(4096);
+
+    EXPECT_EQ(4096, v.size());
+    memset(v.data(), 0xab, v.size());
+    EXPECT_EQ(0xab, v.at(4095));
+}
+
+TEST(htk_stl_vector_tests, vector_resize_default_init_constructs_classes)
+{
+    test_obj::reset();
+    htk::vector<test_obj> v;
+    v.resize_default_init(3);
+
+    EXPECT_EQ(3, v.size());
+    EXPECT_EQ(3, test_obj::constructors);
+}
+
+TEST(htk_stl_vector_tests, vector_shrink_to_fit)
+{
+    htk::vector<int> v;
+    for (int i = 0; i < 11; ++i)
+        v.emplace_back(i);
+    v.shrink_to_fit();
+
+    EXPECT_EQ(11, v.capacity());
+    EXPECT_EQ(10, v.at(10));
+}
+
+TEST(htk_stl_vector_tests, vector_shrink_to_fit_empty)
+{
+    htk::vector<int> v{ 1, 2, 3 };
+    v.clear();
+    v.shrink_to_fit();
+
+    EXPECT_EQ(0, v.capacity());
+    v.emplace_back(1);
+    EXPECT_EQ(1, v.at(0));
+}
+
+// erase
+TEST(htk_stl_vector_tests, vector_erase_one)
+{
+    htk::vector<int> v{ 1, 2, 3, 4 };
+    auto it = v.erase(v.begin() + 1);
+
+    EXPECT_EQ(3, *it);
+    expect_eq_rg({ 1,3,4 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_erase_range)
+{
+    htk::vector<int> v{ 1, 2, 3, 4, 5, 6 };
+    v.erase(v.begin() + 1, v.begin() + 4);
+
+    expect_eq_rg({ 1,5,6 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_class_erase_range)
+{
+    test_obj::reset();
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(3), test_obj(4) };
+    test_obj::reset();
+
+    v.erase(v.begin(), v.begin() + 2);
+
+    expect_eq_rg({ test_obj(3), test_obj(4) }, v);
+    EXPECT_EQ(2, test_obj::move_assigns);
+}
+
+TEST(htk_stl_vector_tests, vector_relocatable_erase_range)
+{
+    htk::vector<relocatable> v;
+    for (int i = 0; i < 5; ++i)
+        v.emplace_back(i);
+
+    v.erase(v.begin() + 1, v.begin() + 3);
+
+    ASSERT_EQ(3, v.size());
+    EXPECT_EQ(0, *v.at(0).owned);
+    EXPECT_EQ(3, *v.at(1).owned);
+    EXPECT_EQ(4, *v.at(2).owned);
+}
+
+TEST(htk_stl_vector_tests, vector_erase_if_pod)
+{
+    htk::vector<int> v;
+    for (int i = 0; i < 103; ++i)
+        v.emplace_back(i);
+
+    const auto removed = htk::erase_if(v, [](int i) { return i % 3 == 0; });
+
+    EXPECT_EQ(35, removed);
+    ASSERT_EQ(68, v.size());
+    for (size_t i = 0; i < v.size(); ++i)
+        EXPECT_NE(0, v.at(i) % 3);
+}
+
+TEST(htk_stl_vector_tests, vector_erase_if_class)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(3), test_obj(4) };
+
+    htk::erase_if(v, [](const test_obj &o) { return o.value_ % 2 == 0; });
+
+    expect_eq_rg({ test_obj(1), test_obj(3) }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_erase_value)
+{
+    htk::vector<int> v{ 1, 2, 1, 3, 1 };
+
+    EXPECT_EQ(3, htk::erase(v, 1));
+    expect_eq_rg({ 2,3 }, v);
+}
+
+// copy and move
+TEST(htk_stl_vector_tests, vector_copy_pod)
+{
+    htk::vector<int> v{ 1, 2, 3 };
+    v.reserve(40);
+    htk::vector<int> copy(v);
+
+    expect_eq_rg({ 1,2,3 }, copy);
+    EXPECT_EQ(3, copy.capacity());
+    EXPECT_NE(v.data(), copy.data());
+}
+
+TEST(htk_stl_vector_tests, vector_copy_empty)
+{
+    htk::vector<int> v;
+    htk::vector<int> copy(v);
+
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(0, copy.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_copy_class)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(3) };
+    test_obj::reset();
+
+    htk::vector<test_obj> copy(v);
+
+    EXPECT_EQ(3, test_obj::copies);
+    expect_eq_rg({ test_obj(1), test_obj(2), test_obj(3) }, copy);
+}
+
+TEST(htk_stl_vector_tests, vector_copy_assign_reuses_capacity)
+{
+    htk::vector<int> v{ 1, 2, 3 };
+    htk::vector<int> target;
+    target.reserve(10);
+    const int *buffer = target.data();
+
+    target = v;
+
+    expect_eq_rg({ 1,2,3 }, target);
+    EXPECT_EQ(buffer, target.data());
+    EXPECT_EQ(10, target.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_copy_assign_grows)
+{
+    htk::vector<int> v{ 1, 2, 3, 4, 5 };
+    htk::vector<int> target{ 9 };
+    target.shrink_to_fit();
+
+    target = v;
+
+    expect_eq_rg({ 1,2,3,4,5 }, target);
+    EXPECT_EQ(5, target.capacity());
+}
+
+TEST(htk_stl_vector_tests, vector_class_copy_assign_longer)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2), test_obj(3) };
+    htk::vector<test_obj> target{ test_obj(7) };
+    target.reserve(10);
+    test_obj::reset();
+
+    target = v;
+
+    EXPECT_EQ(1, test_obj::copy_assigns);
+    EXPECT_EQ(2, test_obj::copies);
+    expect_eq_rg({ test_obj(1), test_obj(2), test_obj(3) }, target);
+}
+
+TEST(htk_stl_vector_tests, vector_class_copy_assign_shorter)
+{
+    htk::vector<test_obj> v{ test_obj(1) };
+    htk::vector<test_obj> target{ test_obj(7), test_obj(8), test_obj(9) };
+    test_obj::reset();
+
+    target = v;
+
+    EXPECT_EQ(1, test_obj::copy_assigns);
+    EXPECT_EQ(2, test_obj::destructors);
+    expect_eq_rg({ test_obj(1) }, target);
+}
+
+TEST(htk_stl_vector_tests, vector_self_assign)
+{
+    htk::vector<int> v{ 1, 2, 3 };
+    auto &alias = v;
+    v = alias;
+
+    expect_eq_rg({ 1,2,3 }, v);
+}
+
+TEST(htk_stl_vector_tests, vector_move_assign_takes_buffer)
+{
+    htk::vector<test_obj> v{ test_obj(1), test_obj(2) };
+    htk::vector<test_obj> target{ test_obj(7) };
+    const test_obj *buffer = v.data();
+    test_obj::reset();
+
+    target = std::move(v);
+
+    EXPECT_EQ(0, test_obj::moves);
+    EXPECT_EQ(buffer, target.data());
+    EXPECT_TRUE(v.empty());
+    expect_eq_rg({ test_obj(1), test_obj(2) }, target);
+}
+
+TEST(htk_stl_vector_tests, vector_copy_selects_allocator)
+{
+    htk::vector<int, tagged_allocator<int, true>> v(tagged_allocator<int, true>(1));
+    v.push_back(1);
+    htk::vector<int, tagged_allocator<int, true>> copy(v);
+
+    EXPECT_EQ(101, copy.get_allocator().id);
+}
+
+TEST(htk_stl_vector_tests, vector_copy_assign_propagates_allocator)
+{
+    htk::vector<int, tagged_allocator<int, true>> v(tagged_allocator<int, true>(1));
+    v.push_back(1);
+    htk::vector<int, tagged_allocator<int, true>> target(tagged_allocator<int, true>(2));
+    target.push_back(2);
+
+    target = v;
+
+    EXPECT_EQ(1, target.get_allocator().id);
+    expect_eq_rg({ 1 }, target);
+}
+
+TEST(htk_stl_vector_tests, vector_copy_assign_keeps_allocator)
+{
+    htk::vector<int, tagged_allocator<int, false>> v(tagged_allocator<int, false>(1));
+    v.push_back(1);
+    htk::vector<int, tagged_allocator<int, false>> target(tagged_allocator<int, false>(2));
+
+    target = v;
+
+    EXPECT_EQ(2, target.get_allocator().id);
+    expect_eq_rg({ 1 }, target);
+}
+
+TEST(htk_stl_vector_tests, vector_move_assign_unequal_allocators_moves_items)
+{
+    htk::vector<test_obj, tagged_allocator<test_obj, false>> v(tagged_allocator<test_obj, false>(1));
+    v.emplace_back(1);
+    v.emplace_back(2);
+    htk::vector<test_obj, tagged_allocator<test_obj, false>> target(tagged_allocator<test_obj, false>(2));
+    const test_obj *buffer = v.data();
+    test_obj::reset();
+
+    target = std::move(v);
+
+    EXPECT_EQ(2, target.get_allocator().id);
+    EXPECT_NE(buffer, target.data());
+    EXPECT_EQ(2, test_obj::moves);
+    EXPECT_TRUE(v.empty());
+    expect_eq_rg({ test_obj(1), test_obj(2) }, target);
+}
+
 // clear
 TEST(htk_stl_vector_tests, vector_clear_pod)
 {
@@ -537,4 +1176,19 @@ TEST(htk_stl_vector_tests, vector_includes_false)
     EXPECT_FALSE(std::includes(v.begin(), v.end(), v1.begin(), v1.end()), "includes wrong");
 }
 
+TEST(htk_stl_vector_tests, vector_unchecked_iterator_is_pointer_sized)
+{
+    using vector = htk::vector<int>;
+    EXPECT_EQ(sizeof(int *), sizeof(vector::unchecked_iterator));
+}
+
+TEST(htk_stl_vector_tests, vector_checked_iterator_sort)
+{
+    using vector = htk::vector<int>;
+    vector v{ 5, 1, 4, 2, 3 };
+    const auto first = &v.at(0);
+    std::sort(vector::checked_iterator(first, &v), vector::checked_iterator(first + v.size(), &v));
+    expect_eq_rg({ 1,2,3,4,5 }, v);
+}
+
 // htk algorithms
\ No newline at end of file
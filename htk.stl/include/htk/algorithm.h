@@ -1,31 +1,297 @@
 #ifndef __algorithm_h__
 #define __algorithm_h__
 
+#include <htk/detail/simd.h>
+#include <htk/iterator.h>
+#include <htk/utility.h>
+
+#include <utility>
+
 namespace htk
 {
+    namespace detail
+    {
+        struct less
+        {
+            template <typename L, typename R>
+            bool operator()(const L &lhs, const R &rhs) const
+            {
+                return lhs < rhs;
+            }
+        };
+
+        /*
+            The search under lower_bound and friends. Returns the first item
+            in [first, first + count) that goes(item) rejects, where goes is
+            true for a prefix of the range and false after it.
+
+            Each level halves the range with a conditional move rather than a
+            branch, so there's nothing for the branch predictor to get wrong,
+            and the loop runs the same log2(count) times for every value.
+            With the branch gone the CPU can't speculate into the next level,
+            so when the items are in memory both of the places the next probe
+            could land are prefetched, keeping a miss a level ahead.
+        */
+        template <typename IteratorT, typename GoesT>
+        IteratorT partition_point(IteratorT first, typename iterator_traits<IteratorT>::difference_type count, GoesT goes)
+        {
+            if (count == 0)
+                return first;
+            while (count > 1)
+            {
+                const auto half = count / 2;
+                if constexpr (is_lvalue_reference_v<typename iterator_traits<IteratorT>::reference>)
+                {
+                    detail::prefetch(&*(first + half / 2));
+                    detail::prefetch(&*(first + (half + half / 2)));
+                }
+                first = goes(*(first + half)) ? first + half : first;
+                count -= half;
+            }
+            return first + static_cast<decltype(count)>(goes(*first));
+        }
+    }
+
+    // the first item not less than v.
+    template <typename IteratorT, typename ValueT, typename CompareT = detail::less>
+    IteratorT lower_bound(IteratorT first, IteratorT last, const ValueT &v, CompareT comp = CompareT{})
+    {
+        return detail::partition_point(first, last - first, [&v, &comp](const auto &item) { return comp(item, v); });
+    }
+
+    // the first item greater than v.
+    template <typename IteratorT, typename ValueT, typename CompareT = detail::less>
+    IteratorT upper_bound(IteratorT first, IteratorT last, const ValueT &v, CompareT comp = CompareT{})
+    {
+        return detail::partition_point(first, last - first, [&v, &comp](const auto &item) { return !comp(v, item); });
+    }
+
+    // the items equal to v, [lower_bound, upper_bound).
+    template <typename IteratorT, typename ValueT, typename CompareT = detail::less>
+    std::pair<IteratorT, IteratorT> equal_range(IteratorT first, IteratorT last, const ValueT &v, CompareT comp = CompareT{})
+    {
+        const IteratorT lower = htk::lower_bound(first, last, v, comp);
+        // everything before lower is less, the upper bound can only be after it.
+        return std::pair<IteratorT, IteratorT>(lower, htk::upper_bound(lower, last, v, comp));
+    }
+
+    /*
+        lower_bound for a whole batch of keys at once, the position of each
+        one in sorted written to out, in order, so out needs room for as many
+        positions as there are keys. Returns the end of what was written.
+
+        One search at a time waits out a cache miss per level, and there's
+        nothing else for the core to do meanwhile. Here the keys go in
+        groups that search in lock step, one level for every key in the
+        group before the next level for any, and each key's next probe is
+        prefetched as soon as it's known. A group's misses are all in flight
+        together, so a level costs about one miss however many keys there
+        are. Every search over the same range takes the same number of
+        steps, so the group never waits on a straggler.
+    */
+    template <typename RangeT, typename KeysT, typename OutputIt, typename CompareT = detail::less>
+    OutputIt batch_lower_bound(const RangeT &sorted, const KeysT &keys, OutputIt out, CompareT comp = CompareT{})
+    {
+        constexpr size_t group = 16;
+        using iterator = remove_cvref_t<decltype(sorted.cbegin())>;
+        using key_iterator = remove_cvref_t<decltype(keys.cbegin())>;
+        using difference_type = typename iterator_traits<iterator>::difference_type;
+        constexpr bool prefetches = is_lvalue_reference_v<typename iterator_traits<iterator>::reference>;
+
+        iterator first = sorted.cbegin();
+        const difference_type count = sorted.cend() - first;
+        // offsets from first rather than iterators, a multiply steps them
+        // without a branch the compiler might put back.
+        difference_type base[group];
+        key_iterator key[group];
+
+        auto next_key = keys.cbegin();
+        const auto last_key = keys.cend();
+        while (next_key != last_key)
+        {
+            size_t in_group = 0;
+            for (; in_group < group && next_key != last_key; ++in_group, ++next_key)
+            {
+                key[in_group] = next_key;
+                base[in_group] = 0;
+            }
+
+            for (difference_type len = count; len > 1;)
+            {
+                const difference_type half = len / 2;
+                len -= half;
+                for (size_t g = 0; g < in_group; ++g)
+                {
+                    base[g] += half * static_cast<difference_type>(comp(*(first + (base[g] + half)), *key[g]));
+                    if constexpr (prefetches)
+                        detail::prefetch(&*(first + (base[g] + len / 2)));
+                }
+            }
+
+            for (size_t g = 0; g < in_group; ++g, ++out)
+            {
+                const difference_type past = count != 0 && comp(*(first + base[g]), *key[g]) ? 1 : 0;
+                *out = base[g] + past;
+            }
+        }
+        return out;
+    }
+
+    template <typename IteratorT, typename ValueT, typename CompareT = detail::less>
+    bool binary_search(IteratorT first, IteratorT last, const ValueT &v, CompareT comp = CompareT{})
+    {
+        const IteratorT found = htk::lower_bound(first, last, v, comp);
+        return found != last && !comp(v, *found);
+    }
+
+    namespace detail
+    {
+        // v as a T, when looking for that finds exactly what == with v would.
+        template <typename T, typename ValueT>
+        bool exactly_as(const ValueT &v, T &out)
+        {
+            if constexpr (is_same_v<remove_cvref_t<ValueT>, T>)
+            {
+                out = v;
+                return true;
+            }
+            else if constexpr (is_integral_v<T> && is_integral_v<remove_cvref_t<ValueT>>)
+            {
+                out = static_cast<T>(v);
+                return static_cast<remove_cvref_t<ValueT>>(out) == v;
+            }
+            else
+                return false;
+        }
+
+        template <typename IteratorT>
+        constexpr bool simd_searchable_range = is_contiguous_iterator_v<IteratorT> &&
+                                               searches_with_simd<remove_cv_t<typename iterator_traits<IteratorT>::value_type>>;
+    }
+
+    /*
+        The first item equal to v, or last. Over contiguous arithmetic items
+        it's a SIMD compare a register at a time, SSE2 or AVX2 depending on
+        the CPU, as long as v converts to the item type without changing.
+    */
     template <typename IteratorT, typename ValueT>
-    bool binary_search(IteratorT begin, IteratorT end, const ValueT &v)
-    {
-        const int mid = (end - begin) / 2;
-        if (mid == 0)
-            return *begin == v ? true : ( *(end-1) == v ? true  : false);
-        const auto midval = *(begin + mid);
-        if (midval == v)
-            return true;
-        else if (v < midval)
-            return htk::binary_search(begin, begin+mid, v);
-        else
-            return htk::binary_search(begin + mid, end, v);
+    IteratorT find(IteratorT first, IteratorT last, const ValueT &v)
+    {
+        if constexpr (detail::simd_searchable_range<IteratorT>)
+        {
+            remove_cv_t<typename iterator_traits<IteratorT>::value_type> value;
+            if (first != last && detail::exactly_as(v, value))
+            {
+                const auto begin = &*first;
+                const auto found = detail::find(begin, begin + (last - first), value);
+                return first + static_cast<typename iterator_traits<IteratorT>::difference_type>(found - begin);
+            }
+        }
+        for (; first != last; ++first)
+        {
+            if (*first == v)
+                return first;
+        }
+        return last;
     }
+
+    // how many items are equal to v.
+    template <typename IteratorT, typename ValueT>
+    typename iterator_traits<IteratorT>::difference_type count(IteratorT first, IteratorT last, const ValueT &v)
+    {
+        using difference_type = typename iterator_traits<IteratorT>::difference_type;
+        if constexpr (detail::simd_searchable_range<IteratorT>)
+        {
+            remove_cv_t<typename iterator_traits<IteratorT>::value_type> value;
+            if (first != last && detail::exactly_as(v, value))
+            {
+                const auto begin = &*first;
+                return static_cast<difference_type>(detail::count(begin, begin + (last - first), value));
+            }
+        }
+        difference_type count = 0;
+        for (; first != last; ++first)
+            count += *first == v;
+        return count;
+    }
+
+    /*
+        The first item equal to any of [needles_first, needles_last), or
+        last. The short list membership test: each register of items is
+        compared against all of the needles at once, for up to 16 of them.
+    */
+    template <typename IteratorT, typename NeedleIteratorT>
+    IteratorT find_if_equal_any(IteratorT first, IteratorT last, NeedleIteratorT needles_first, NeedleIteratorT needles_last)
+    {
+        using value_type = remove_cv_t<typename iterator_traits<IteratorT>::value_type>;
+        if constexpr (detail::simd_searchable_range<IteratorT>)
+        {
+            value_type needles[detail::max_simd_needles];
+            size_t count = 0;
+            bool exact = true;
+            for (auto n = needles_first; n != needles_last && exact; ++n)
+                exact = count < detail::max_simd_needles && detail::exactly_as(*n, needles[count++]);
+            if (first != last && exact)
+            {
+                const auto begin = &*first;
+                const auto found = detail::find_any(begin, begin + (last - first), needles, count);
+                return first + static_cast<typename iterator_traits<IteratorT>::difference_type>(found - begin);
+            }
+        }
+        for (; first != last; ++first)
+        {
+            for (auto n = needles_first; n != needles_last; ++n)
+            {
+                if (*first == *n)
+                    return first;
+            }
+        }
+        return last;
+    }
+
     template <typename IteratorT, typename ValueT>
     bool linear_search(IteratorT begin, IteratorT end, const ValueT &v)
     {
-        for (; begin != end; ++begin)
+        return htk::find(begin, end, v) != end;
+    }
+
+    /*
+        Moves everything pred rejects to the front, in order, and returns the
+        new end. Over contiguous, trivially copyable items it's the
+        branchless stream compaction kernel, vectorized where the CPU allows.
+    */
+    template <typename IteratorT, typename PredT>
+    IteratorT remove_if(IteratorT first, IteratorT last, PredT pred)
+    {
+        using value_type = typename iterator_traits<IteratorT>::value_type;
+        if constexpr (is_contiguous_iterator_v<IteratorT> && is_trivially_copyable_v<value_type>)
         {
-            if (*begin == v)
-                return true;
+            if (first == last)
+                return first;
+            // undress() overloads live with their containers, so go through the item
+            const auto begin = &*first;
+            const auto end = detail::compact(begin, begin + (last - first), pred);
+            return first + static_cast<typename iterator_traits<IteratorT>::difference_type>(end - begin);
+        }
+        else
+        {
+            IteratorT write = first;
+            for (; first != last; ++first)
+            {
+                if (!pred(*first))
+                {
+                    *write = htk::move(*first);
+                    ++write;
+                }
+            }
+            return write;
         }
-        return false;
+    }
+
+    template <typename IteratorT, typename ValueT>
+    IteratorT remove(IteratorT first, IteratorT last, const ValueT &v)
+    {
+        return htk::remove_if(first, last, [&v](const auto &item) { return item == v; });
     }
 }
 
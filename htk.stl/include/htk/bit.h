@@ -0,0 +1,94 @@
+#ifndef __htk_bit_h__
+#define __htk_bit_h__
+
+#include <htk/type_traits.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+    The handful of <bit> operations the containers and algorithms lean on.
+    Each one is a single instruction where the compiler offers one.
+*/
+
+namespace htk
+{
+    // number of set bits.
+    template <typename T>
+    int popcount(T value) noexcept
+    {
+        const auto x = static_cast<unsigned long long>(value);
+#if defined(_MSC_VER) && defined(_M_X64)
+        return static_cast<int>(__popcnt64(x));
+#elif defined(_MSC_VER)
+        return static_cast<int>(__popcnt(static_cast<unsigned int>(x)) + __popcnt(static_cast<unsigned int>(x >> 32)));
+#else
+        return __builtin_popcountll(x);
+#endif
+    }
+
+    // number of zero bits below the lowest set bit, the width of T for 0.
+    template <typename T>
+    int countr_zero(T value) noexcept
+    {
+        constexpr int width = sizeof(T) * 8;
+        const auto x = static_cast<unsigned long long>(value);
+        if (x == 0)
+            return width;
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return static_cast<int>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(x)))
+            return static_cast<int>(index);
+        _BitScanForward(&index, static_cast<unsigned long>(x >> 32));
+        return static_cast<int>(index) + 32;
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    // number of zero bits above the highest set bit, the width of T for 0.
+    template <typename T>
+    int countl_zero(T value) noexcept
+    {
+        constexpr int width = sizeof(T) * 8;
+        const auto x = static_cast<unsigned long long>(value);
+        if (x == 0)
+            return width;
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, x);
+        return width - 1 - static_cast<int>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanReverse(&index, static_cast<unsigned long>(x >> 32)))
+            return width - 33 - static_cast<int>(index);
+        _BitScanReverse(&index, static_cast<unsigned long>(x));
+        return width - 1 - static_cast<int>(index);
+#else
+        return __builtin_clzll(x) - (64 - width);
+#endif
+    }
+
+    namespace detail
+    {
+        // floor(log2(value)), for when it has to be a constant.
+        constexpr int log2(unsigned long long value)
+        {
+            return value <= 1 ? 0 : 1 + log2(value >> 1);
+        }
+    }
+
+    // bits needed to hold value, floor(log2(value)) + 1, 0 for 0.
+    template <typename T>
+    int bit_width(T value) noexcept
+    {
+        return static_cast<int>(sizeof(T) * 8) - countl_zero(value);
+    }
+}
+
+#endif // __htk_bit_h__
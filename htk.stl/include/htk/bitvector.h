@@ -0,0 +1,461 @@
+#ifndef __htk_bitvector_h__
+#define __htk_bitvector_h__
+
+#include <htk/bit.h>
+#include <htk/detail/simd.h>
+#include <htk/exception.h>
+#include <htk/memory.h>
+#include <htk/stdexcept.h>
+#include <htk/vector.h>
+
+#include <stdint.h>
+
+namespace htk
+{
+    /*
+        A vector of bools, a bit each, packed into 64 bit words. Eight times
+        smaller than a vector<uint8_t> of flags, and most operations work on
+        a word, 64 bits, at a time: count() is a popcount per word, finding
+        the next set (or unset) bit skips whole words with SIMD and then takes
+        a countr_zero, and &, | and ^ are a register of words at a time.
+
+        The bits of the last word past size() are always zero, everything
+        that counts or searches leans on that.
+
+        rank() and select() are popcounts over the words, linear in the
+        position. Something that asks them over and over of a vector that
+        doesn't change wants a directory of counts on top.
+    */
+    template <typename AllocatorT = htk::allocator<uint64_t>>
+    class bitvector
+    {
+    public:
+        using word_type = uint64_t;
+        using value_type = bool;
+        using size_type = htk::size_t;
+        using difference_type = htk::ptrdiff_t;
+        using allocator_type = AllocatorT;
+
+        static constexpr size_type word_bits = sizeof(word_type) * 8;
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        // what operator[] hands out, a word and a bit in it.
+        class reference
+        {
+        public:
+            reference(word_type &word, size_type bit)
+                : word_(word), mask_(word_type(1) << bit)
+            {
+            }
+
+            operator bool() const
+            {
+                return (word_ & mask_) != 0;
+            }
+
+            reference &operator=(bool value)
+            {
+                word_ = value ? word_ | mask_ : word_ & ~mask_;
+                return *this;
+            }
+
+            reference &operator=(const reference &rhs)
+            {
+                return *this = static_cast<bool>(rhs);
+            }
+
+            void flip()
+            {
+                word_ ^= mask_;
+            }
+
+        private:
+            word_type &word_;
+            word_type mask_;
+        };
+
+        bitvector()
+            : size_(0)
+        {
+        }
+
+        explicit bitvector(size_type count, bool value = false)
+            : size_(0)
+        {
+            resize(count, value);
+        }
+
+        explicit bitvector(const AllocatorT &allocator)
+            : words_(allocator), size_(0)
+        {
+        }
+
+    public: // modifiers
+        void push_back(bool value)
+        {
+            const auto bit = size_ % word_bits;
+            if (bit == 0)
+                words_.push_back(word_type(value));
+            else
+                words_.back() |= word_type(value) << bit;
+            ++size_;
+        }
+
+        // the low count bits of bits, in one go.
+        void push_back_bits(word_type bits, size_type count = word_bits)
+        {
+            if (count > word_bits)
+                throw out_of_range("a word holds 64 bits");
+            if (count == 0)
+                return;
+            bits &= low_mask(count);
+            const auto bit = size_ % word_bits;
+            if (bit == 0)
+                words_.push_back(bits);
+            else
+            {
+                words_.back() |= bits << bit;
+                if (bit + count > word_bits)
+                    words_.push_back(bits >> (word_bits - bit));
+            }
+            size_ += count;
+        }
+
+        void pop_back()
+        {
+            if (empty())
+                throw htk::exception("pop_back() called on empty bitvector");
+            resize(size_ - 1);
+        }
+
+        void resize(size_type count, bool value = false)
+        {
+            if (count < size_)
+            {
+                words_.resize(words_for(count));
+                size_ = count;
+                clear_tail();
+                return;
+            }
+
+            const word_type fill = value ? ~word_type(0) : 0;
+            if (value && size_ % word_bits != 0)
+                words_.back() |= ~low_mask(size_ % word_bits);
+            words_.resize(words_for(count), fill);
+            size_ = count;
+            clear_tail();
+        }
+
+        void clear()
+        {
+            words_.clear();
+            size_ = 0;
+        }
+
+        void set(size_type pos, bool value = true)
+        {
+            check_index(pos);
+            (*this)[pos] = value;
+        }
+
+        void reset(size_type pos)
+        {
+            set(pos, false);
+        }
+
+        void flip(size_type pos)
+        {
+            check_index(pos);
+            words_.data()[pos / word_bits] ^= word_type(1) << (pos % word_bits);
+        }
+
+        // every bit.
+        void set()
+        {
+            for (auto &word : words_)
+                word = ~word_type(0);
+            clear_tail();
+        }
+
+        void reset()
+        {
+            for (auto &word : words_)
+                word = 0;
+        }
+
+        /*
+            The bitwise operators, bit i with bit i of rhs over [first, last).
+            The words wholly inside the range go through the SIMD kernels,
+            the partial ones at either end are masked.
+        */
+        void bit_and(const bitvector &rhs, size_type first, size_type last)
+        {
+            combine<detail::bit_op::and_>(rhs, first, last);
+        }
+
+        void bit_or(const bitvector &rhs, size_type first, size_type last)
+        {
+            combine<detail::bit_op::or_>(rhs, first, last);
+        }
+
+        void bit_xor(const bitvector &rhs, size_type first, size_type last)
+        {
+            combine<detail::bit_op::xor_>(rhs, first, last);
+        }
+
+        bitvector &operator&=(const bitvector &rhs)
+        {
+            check_same_size(rhs);
+            combine<detail::bit_op::and_>(rhs, 0, size_);
+            return *this;
+        }
+
+        bitvector &operator|=(const bitvector &rhs)
+        {
+            check_same_size(rhs);
+            combine<detail::bit_op::or_>(rhs, 0, size_);
+            return *this;
+        }
+
+        bitvector &operator^=(const bitvector &rhs)
+        {
+            check_same_size(rhs);
+            combine<detail::bit_op::xor_>(rhs, 0, size_);
+            return *this;
+        }
+
+    public: // access
+        bool operator[](size_type pos) const
+        {
+            return (words_.data()[pos / word_bits] >> (pos % word_bits)) & 1;
+        }
+
+        reference operator[](size_type pos)
+        {
+            return reference(words_.data()[pos / word_bits], pos % word_bits);
+        }
+
+        bool test(size_type pos) const
+        {
+            check_index(pos);
+            return (*this)[pos];
+        }
+
+        bool at(size_type pos) const
+        {
+            return test(pos);
+        }
+
+        const word_type *words() const noexcept
+        {
+            return words_.data();
+        }
+
+        size_type word_count() const
+        {
+            return static_cast<size_type>(words_.size());
+        }
+
+    public: // search
+        // the number of set bits.
+        size_type count() const
+        {
+            const word_type *words = words_.data();
+            size_type total = 0;
+            for (size_type w = 0, count = word_count(); w < count; ++w)
+                total += htk::popcount(words[w]);
+            return total;
+        }
+
+        size_type count(bool value) const
+        {
+            return value ? count() : size_ - count();
+        }
+
+        bool any() const
+        {
+            return find_first() != npos;
+        }
+
+        bool all() const
+        {
+            return find_first(false) == npos;
+        }
+
+        bool none() const
+        {
+            return !any();
+        }
+
+        // the first bit equal to value, npos if there isn't one.
+        size_type find_first(bool value = true) const
+        {
+            return find_from(0, value);
+        }
+
+        // the first bit after pos equal to value, npos if there isn't one.
+        size_type find_next(size_type pos, bool value = true) const
+        {
+            if (pos == npos || pos + 1 >= size_)
+                return npos;
+            return find_from(pos + 1, value);
+        }
+
+        // the number of set bits in [0, pos).
+        size_type rank(size_type pos) const
+        {
+            if (pos > size_)
+                throw out_of_range("rank past the end");
+            const word_type *words = words_.data();
+            const size_type whole = pos / word_bits;
+            size_type total = 0;
+            for (size_type w = 0; w < whole; ++w)
+                total += htk::popcount(words[w]);
+            if (pos % word_bits != 0)
+                total += htk::popcount(words[whole] & low_mask(pos % word_bits));
+            return total;
+        }
+
+        // the position of the set bit with rank n (0 is the first), npos
+        // if there are n or fewer.
+        size_type select(size_type n) const
+        {
+            const word_type *words = words_.data();
+            const size_type count = word_count();
+            for (size_type w = 0; w < count; ++w)
+            {
+                const auto ones = static_cast<size_type>(htk::popcount(words[w]));
+                if (n < ones)
+                {
+                    word_type word = words[w];
+                    for (; n != 0; --n)
+                        word &= word - 1;
+                    return w * word_bits + htk::countr_zero(word);
+                }
+                n -= ones;
+            }
+            return npos;
+        }
+
+    public: // capacity
+        void reserve(size_type count)
+        {
+            words_.reserve(words_for(count));
+        }
+
+        size_t capacity() const noexcept
+        {
+            return words_.capacity() * word_bits;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+    private:
+        static size_type words_for(size_type bits)
+        {
+            return (bits + word_bits - 1) / word_bits;
+        }
+
+        // the low count bits, count in [0, 64].
+        static word_type low_mask(size_type count)
+        {
+            return count >= word_bits ? ~word_type(0) : (word_type(1) << count) - 1;
+        }
+
+        void clear_tail()
+        {
+            if (size_ % word_bits != 0)
+                words_.back() &= low_mask(size_ % word_bits);
+        }
+
+        void check_index(size_type pos) const
+        {
+            if (pos >= size_)
+                throw out_of_range("index out of range");
+        }
+
+        void check_same_size(const bitvector &rhs) const
+        {
+            if (rhs.size_ != size_)
+                throw invalid_operation("bitvectors are different sizes");
+        }
+
+        size_type find_from(size_type pos, bool value) const
+        {
+            if (pos >= size_)
+                return npos;
+            const word_type *words = words_.data();
+            const word_type flip = value ? 0 : ~word_type(0);
+            const size_type last_word = word_count();
+
+            // the first word, less the bits before pos.
+            size_type w = pos / word_bits;
+            const word_type first = (words[w] ^ flip) & ~low_mask(pos % word_bits) & valid_bits(w);
+            if (first != 0)
+                return w * word_bits + htk::countr_zero(first);
+
+            // whole words after it, skipping the ones with nothing to find.
+            ++w;
+            const word_type *found = detail::find_word_not(words + w, words + last_word, flip);
+            if (found == words + last_word)
+                return npos;
+            w = static_cast<size_type>(found - words);
+            const word_type hit = (*found ^ flip) & valid_bits(w);
+            return hit == 0 ? npos : w * word_bits + htk::countr_zero(hit);
+        }
+
+        // the bits of word w that are inside size().
+        word_type valid_bits(size_type w) const
+        {
+            return w + 1 < word_count() || size_ % word_bits == 0 ? ~word_type(0) : low_mask(size_ % word_bits);
+        }
+
+        template <detail::bit_op Op>
+        void combine(const bitvector &rhs, size_type first, size_type last)
+        {
+            if (first > last || last > size_ || last > rhs.size_)
+                throw out_of_range("range out of range");
+            if (first == last)
+                return;
+
+            word_type *dst = words_.data();
+            const word_type *src = rhs.words_.data();
+            const size_type first_word = first / word_bits;
+            const size_type last_word = (last - 1) / word_bits;
+
+            auto masked = [dst, src](size_type w, word_type mask) {
+                dst[w] = (dst[w] & ~mask) | (detail::apply_bit_op<Op>(dst[w], src[w]) & mask);
+            };
+
+            const word_type head = ~low_mask(first % word_bits);
+            const word_type tail = low_mask((last - 1) % word_bits + 1);
+            if (first_word == last_word)
+            {
+                masked(first_word, head & tail);
+                return;
+            }
+
+            size_type inner_first = first_word;
+            if (first % word_bits != 0)
+                masked(inner_first++, head);
+            size_type inner_last = last_word + 1;
+            if (last % word_bits != 0)
+                masked(--inner_last, tail);
+            if (inner_first < inner_last)
+                detail::bitwise<Op>(dst + inner_first, src + inner_first, inner_last - inner_first);
+        }
+
+        htk::vector<word_type, AllocatorT> words_;
+        size_type size_;
+    };
+}
+
+#endif // __htk_bitvector_h__
@@ -0,0 +1,298 @@
+#ifndef __htk_concurrent_vector_h__
+#define __htk_concurrent_vector_h__
+
+#include <htk/exception.h>
+#include <htk/iterator.h>
+#include <htk/memory.h>
+#include <htk/stable_vector.h>
+#include <htk/stdexcept.h>
+#include <htk/utility.h>
+
+#include <atomic>
+
+namespace htk
+{
+    /*
+        Forward iterator over a concurrent_vector. It covers the indices
+        handed out when it was made, and steps over the ones that aren't
+        ready, items still being built or whose constructor threw.
+    */
+    template <typename ConcurrentVectorT>
+    class concurrent_vector_iterator
+    {
+    public:
+        using iterator_category = forward_iterator_tag;
+        using difference_type = typename ConcurrentVectorT::difference_type;
+        using value_type = typename ConcurrentVectorT::value_type;
+        using pointer = typename ConcurrentVectorT::pointer;
+        using reference = typename ConcurrentVectorT::reference;
+        using size_type = typename ConcurrentVectorT::size_type;
+
+        concurrent_vector_iterator()
+            : vec_(nullptr), index_(0), end_(0)
+        {
+        }
+
+        concurrent_vector_iterator(const ConcurrentVectorT *vec, size_type index, size_type end)
+            : vec_(vec), index_(index), end_(end)
+        {
+            skip_unready();
+        }
+
+        reference operator*() const
+        {
+            return *vec_->locate(index_);
+        }
+
+        pointer operator->() const
+        {
+            return vec_->locate(index_);
+        }
+
+        concurrent_vector_iterator &operator++()
+        {
+            ++index_;
+            skip_unready();
+            return *this;
+        }
+
+        concurrent_vector_iterator operator++(int)
+        {
+            concurrent_vector_iterator tmp{ *this };
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const concurrent_vector_iterator &rhs) const { return index_ == rhs.index_; }
+        bool operator!=(const concurrent_vector_iterator &rhs) const { return index_ != rhs.index_; }
+
+        size_type index() const { return index_; }
+
+    private:
+        void skip_unready()
+        {
+            while (index_ < end_ && !vec_->ready(index_))
+                ++index_;
+        }
+
+        const ConcurrentVectorT *vec_;
+        size_type index_;
+        size_type end_;
+    };
+
+    /*
+        A vector any number of threads can append to at once, without a
+        lock. It's laid out like stable_vector, segments doubling in size
+        under a fixed directory, so nothing ever moves and an item can be
+        read while others are being appended.
+
+        An append is three steps:
+
+        1. reserve an index, a fetch_add on reserved_.
+        2. make sure the index's segment exists. Whoever gets there first
+           allocates it and CASes it into the directory; a thread that loses
+           the race frees its segment and uses the winner's.
+        3. construct the item, then mark its slot ready.
+
+        No append waits for another, so a thread that's descheduled midway,
+        or whose constructor throws, only holds up its own slot. The price is
+        that slots become ready out of order: size() is the indices handed
+        out so far, and ready(i) says whether item i has been built. at()
+        throws for an item that isn't ready, and iterators step over them.
+
+        Appending is the only thing that's safe to do concurrently. clear()
+        and destruction need everyone else to be done.
+    */
+    template <typename T, typename AllocatorT = htk::allocator<T>, size_t SegmentSize = 64>
+    class concurrent_vector
+    {
+        using layout = detail::geometric_segments<SegmentSize>;
+        using slot_state = std::atomic<unsigned char>;
+
+        template <typename>
+        friend class concurrent_vector_iterator;
+
+    public:
+        using value_type = T;
+        using reference = T &;
+        using const_reference = const T &;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using iterator = concurrent_vector_iterator<concurrent_vector>;
+        using const_iterator = const iterator;
+        using difference_type = htk::ptrdiff_t;
+        using size_type = htk::size_t;
+        using allocator_type = AllocatorT;
+
+        static constexpr size_t segment_size = SegmentSize;
+        static constexpr size_t max_segments = layout::max_segments;
+
+        concurrent_vector()
+            : reserved_(0)
+        {
+            for (size_type s = 0; s < max_segments; ++s)
+            {
+                directory_[s].store(nullptr, std::memory_order_relaxed);
+                states_[s].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        concurrent_vector(const concurrent_vector &) = delete;
+        concurrent_vector &operator=(const concurrent_vector &) = delete;
+
+        ~concurrent_vector() noexcept
+        {
+            clear();
+            for (size_type s = 0; s < max_segments; ++s)
+            {
+                const pointer segment = directory_[s].load(std::memory_order_relaxed);
+                if (segment != nullptr)
+                    allocator_.deallocate(segment, layout::segment_capacity(s));
+                delete[] states_[s].load(std::memory_order_relaxed);
+            }
+        }
+
+    public: // modifiers
+        // safe from any number of threads. returns the new item's index.
+        template <typename... Args>
+        size_type emplace_back(Args &&... args)
+        {
+            const size_type index = reserved_.fetch_add(1, std::memory_order_relaxed);
+            const auto [segment, offset] = layout::split(index);
+            if (segment >= max_segments)
+                throw bad_alloc("concurrent_vector is out of segments");
+
+            slot_state *states = ensure_states(segment);
+            const pointer p = ensure_segment(segment) + offset;
+            allocator_.construct(*p, htk::forward<Args>(args)...);
+            states[offset].store(ready_state, std::memory_order_release);
+            return index;
+        }
+
+        size_type push_back(const T &item)
+        {
+            return emplace_back(item);
+        }
+
+        size_type push_back(T &&item)
+        {
+            return emplace_back(htk::move(item));
+        }
+
+        // destroys everything, keeping the segments. not safe alongside appends.
+        void clear()
+        {
+            const size_type count = size();
+            for (size_type i = 0; i < count; ++i)
+            {
+                if (!ready(i))
+                    continue;
+                allocator_.destroy(locate(i));
+                state(i)->store(empty_state, std::memory_order_relaxed);
+            }
+            reserved_.store(0, std::memory_order_release);
+        }
+
+    public: // access
+        // whether item index has been built, and can be read.
+        bool ready(size_type index) const
+        {
+            const auto [segment, offset] = layout::split(index);
+            if (segment >= max_segments)
+                return false;
+            const slot_state *states = states_[segment].load(std::memory_order_acquire);
+            return states != nullptr && states[offset].load(std::memory_order_acquire) == ready_state;
+        }
+
+        T &at(size_type index)
+        {
+            check_ready(index);
+            return *locate(index);
+        }
+
+        const T &at(size_type index) const
+        {
+            check_ready(index);
+            return *locate(index);
+        }
+
+        // iterators cover the indices handed out when they were made.
+        iterator begin() { return iterator(this, 0, size()); }
+        iterator end() { return iterator(this, size(), size()); }
+        const_iterator cbegin() const { return iterator(this, 0, size()); }
+        const_iterator cend() const { return iterator(this, size(), size()); }
+
+    public: // capacity
+        // the indices handed out, ready or not.
+        size_t size() const
+        {
+            const size_type reserved = reserved_.load(std::memory_order_acquire);
+            const size_type most = static_cast<size_type>(layout::capacity(max_segments));
+            return reserved < most ? reserved : most;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+        static constexpr unsigned char empty_state = 0;
+        static constexpr unsigned char ready_state = 1;
+
+        void check_ready(size_type index) const
+        {
+            if (index >= size())
+                throw out_of_range("index out of range");
+            if (!ready(index))
+                throw invalid_operation("item isn't ready");
+        }
+
+        pointer locate(size_type index) const
+        {
+            const auto [segment, offset] = layout::split(index);
+            return directory_[segment].load(std::memory_order_acquire) + offset;
+        }
+
+        slot_state *state(size_type index) const
+        {
+            const auto [segment, offset] = layout::split(index);
+            return states_[segment].load(std::memory_order_acquire) + offset;
+        }
+
+        pointer ensure_segment(size_type segment)
+        {
+            pointer existing = directory_[segment].load(std::memory_order_acquire);
+            if (existing != nullptr)
+                return existing;
+
+            const pointer fresh = allocator_.allocate(layout::segment_capacity(segment));
+            if (directory_[segment].compare_exchange_strong(existing, fresh, std::memory_order_acq_rel))
+                return fresh;
+            // somebody beat us to it, existing is theirs.
+            allocator_.deallocate(fresh, layout::segment_capacity(segment));
+            return existing;
+        }
+
+        // the same race for the segment's ready flags, all empty to start.
+        slot_state *ensure_states(size_type segment)
+        {
+            slot_state *existing = states_[segment].load(std::memory_order_acquire);
+            if (existing != nullptr)
+                return existing;
+
+            slot_state *fresh = new slot_state[layout::segment_capacity(segment)]();
+            if (states_[segment].compare_exchange_strong(existing, fresh, std::memory_order_acq_rel))
+                return fresh;
+            delete[] fresh;
+            return existing;
+        }
+
+        std::atomic<size_type> reserved_;
+        std::atomic<pointer> directory_[max_segments];
+        std::atomic<slot_state *> states_[max_segments];
+        AllocatorT allocator_;
+    };
+}
+
+#endif // __htk_concurrent_vector_h__
@@ -0,0 +1,681 @@
+#ifndef __htk_detail_simd_h__
+#define __htk_detail_simd_h__
+
+#include <htk/bit.h>
+#include <htk/type_traits.h>
+#include <htk/types.h>
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    SIMD support for the algorithms and containers.
+
+    Kernels are compiled for the instruction set they need regardless of the
+    compiler flags (MSVC lets any intrinsic through, gcc/clang need the
+    target attribute), and picked at runtime from what cpuid reports. So the
+    same binary uses SSSE3 or AVX2 where it can, and the scalar code where
+    it can't.
+*/
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HTK_X86 1
+#else
+#define HTK_X86 0
+#endif
+
+#if HTK_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HTK_TARGET(isa)
+#else
+#include <cpuid.h>
+#define HTK_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace htk
+{
+    namespace detail
+    {
+        struct cpu_features
+        {
+            bool sse2;
+            bool ssse3;
+            bool sse41;
+            bool avx2;
+        };
+
+#if HTK_X86
+        inline void cpuid(int leaf, int subleaf, unsigned int regs[4])
+        {
+#if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, leaf, subleaf);
+            for (int i = 0; i < 4; ++i)
+                regs[i] = static_cast<unsigned int>(r[i]);
+#else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+
+        // the OS has to be saving the ymm registers for AVX to be usable.
+        inline bool os_saves_ymm()
+        {
+#if defined(_MSC_VER)
+            return (_xgetbv(0) & 0x6) == 0x6;
+#else
+            unsigned int eax, edx;
+            __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (eax & 0x6) == 0x6;
+#endif
+        }
+
+        inline cpu_features detect_cpu_features()
+        {
+            cpu_features f{ false, false, false, false };
+            unsigned int regs[4];
+            cpuid(0, 0, regs);
+            const auto max_leaf = regs[0];
+            if (max_leaf < 1)
+                return f;
+
+            cpuid(1, 0, regs);
+            f.sse2 = (regs[3] & (1u << 26)) != 0;
+            f.ssse3 = (regs[2] & (1u << 9)) != 0;
+            f.sse41 = (regs[2] & (1u << 19)) != 0;
+            const bool osxsave = (regs[2] & (1u << 27)) != 0;
+            const bool avx = (regs[2] & (1u << 28)) != 0;
+
+            if (max_leaf >= 7 && osxsave && avx && os_saves_ymm())
+            {
+                cpuid(7, 0, regs);
+                f.avx2 = (regs[1] & (1u << 5)) != 0;
+            }
+            return f;
+        }
+#else
+        inline cpu_features detect_cpu_features()
+        {
+            return cpu_features{ false, false, false, false };
+        }
+#endif
+
+        // detected once, on first use.
+        inline const cpu_features &cpu()
+        {
+            static const cpu_features features = detect_cpu_features();
+            return features;
+        }
+
+        // a hint that p is about to be read. never faults, whatever p is.
+        inline void prefetch(const void *p)
+        {
+#if HTK_X86
+            _mm_prefetch(static_cast<const char *>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+            __builtin_prefetch(p);
+#else
+            (void)p;
+#endif
+        }
+
+        /*
+            Stream compaction. Keeps the items pred rejects, in order, and
+            returns the new end. A block of lanes is tested into a bit mask,
+            a shuffle from the table below packs the kept lanes down to the
+            front of the register, and the whole register is stored at the
+            write position, which then moves by the number kept. No branch
+            depends on the data.
+
+            Storing a full register can scribble past the kept items, but
+            never past the block being read, so it stays inside the range.
+        */
+        template <size_t LaneBytes>
+        struct compact_table
+        {
+            static constexpr size_t lanes = 16 / LaneBytes;
+            static constexpr size_t entries = size_t(1) << lanes;
+            alignas(16) unsigned char shuffle[entries][16];
+        };
+
+        template <size_t LaneBytes>
+        constexpr compact_table<LaneBytes> make_compact_table()
+        {
+            compact_table<LaneBytes> table{};
+            for (size_t mask = 0; mask < table.entries; ++mask)
+            {
+                size_t out = 0;
+                for (size_t lane = 0; lane < table.lanes; ++lane)
+                {
+                    if ((mask >> lane) & 1)
+                    {
+                        for (size_t b = 0; b < LaneBytes; ++b)
+                            table.shuffle[mask][out * LaneBytes + b] = static_cast<unsigned char>(lane * LaneBytes + b);
+                        ++out;
+                    }
+                }
+                for (size_t b = out * LaneBytes; b < 16; ++b)
+                    table.shuffle[mask][b] = 0x80;
+            }
+            return table;
+        }
+
+        template <size_t LaneBytes>
+        inline constexpr compact_table<LaneBytes> compact_shuffles = make_compact_table<LaneBytes>();
+
+        // the branchless scalar version, also used for the tail.
+        template <typename T, typename PredT>
+        T *compact_scalar(T *first, T *last, T *write, PredT &pred)
+        {
+            for (; first != last; ++first)
+            {
+                const T value = *first;
+                *write = value;
+                write += !pred(value);
+            }
+            return write;
+        }
+
+#if HTK_X86
+        template <typename T, typename PredT>
+        HTK_TARGET("ssse3")
+        T *compact_ssse3(T *first, T *last, PredT &pred)
+        {
+            constexpr size_t lanes = 16 / sizeof(T);
+            T *write = first;
+            for (; last - first >= static_cast<ptrdiff_t>(lanes); first += lanes)
+            {
+                unsigned int keep = 0;
+                for (size_t lane = 0; lane < lanes; ++lane)
+                    keep |= static_cast<unsigned int>(!pred(first[lane])) << lane;
+
+                const __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(compact_shuffles<sizeof(T)>.shuffle[keep]));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(write), _mm_shuffle_epi8(items, shuffle));
+                write += htk::popcount(keep);
+            }
+            return compact_scalar(first, last, write, pred);
+        }
+#endif
+
+        template <typename T>
+        constexpr bool compacts_with_simd = htk::is_trivially_copyable_v<T> && (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+        template <typename T, typename PredT>
+        T *compact(T *first, T *last, PredT &pred)
+        {
+#if HTK_X86
+            if constexpr (compacts_with_simd<T>)
+            {
+                if (cpu().ssse3)
+                    return compact_ssse3(first, last, pred);
+            }
+#endif
+            return compact_scalar(first, last, first, pred);
+        }
+
+        /*
+            Equality search over contiguous arithmetic items. A register of
+            items is compared against the value broadcast to every lane,
+            movemask turns the compare into a bit per byte, and the first set
+            bit (or how many there are) gives the answer, a register at a
+            time. find_any compares each register against every needle and
+            ors the results.
+
+            Floating point compares are the ordered ones, so NaN matches
+            nothing and -0.0 matches 0.0, the same as ==.
+        */
+        template <typename T>
+        constexpr bool searches_with_simd = htk::is_arithmetic_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+        // more needles than this and find_any is the scalar loop.
+        constexpr size_t max_simd_needles = 16;
+
+        template <typename T>
+        const T *find_scalar(const T *first, const T *last, T value)
+        {
+            for (; first != last; ++first)
+            {
+                if (*first == value)
+                    return first;
+            }
+            return last;
+        }
+
+        template <typename T>
+        size_t count_scalar(const T *first, const T *last, T value)
+        {
+            size_t count = 0;
+            for (; first != last; ++first)
+                count += *first == value;
+            return count;
+        }
+
+        template <typename T>
+        const T *find_any_scalar(const T *first, const T *last, const T *needles, size_t needle_count)
+        {
+            for (; first != last; ++first)
+            {
+                for (size_t n = 0; n < needle_count; ++n)
+                {
+                    if (*first == needles[n])
+                        return first;
+                }
+            }
+            return last;
+        }
+
+#if HTK_X86
+        // the bits of value, in an integer the same size.
+        template <typename T>
+        long long splat_bits(T value)
+        {
+            if constexpr (sizeof(T) == 1)
+            {
+                unsigned char bits;
+                memcpy(&bits, &value, 1);
+                return bits;
+            }
+            else if constexpr (sizeof(T) == 2)
+            {
+                unsigned short bits;
+                memcpy(&bits, &value, 2);
+                return bits;
+            }
+            else if constexpr (sizeof(T) == 4)
+            {
+                unsigned int bits;
+                memcpy(&bits, &value, 4);
+                return bits;
+            }
+            else
+            {
+                long long bits;
+                memcpy(&bits, &value, 8);
+                return bits;
+            }
+        }
+
+        template <typename T>
+        HTK_TARGET("sse2")
+        __m128i splat_sse2(T value)
+        {
+            const auto bits = splat_bits(value);
+            if constexpr (sizeof(T) == 1)
+                return _mm_set1_epi8(static_cast<char>(bits));
+            else if constexpr (sizeof(T) == 2)
+                return _mm_set1_epi16(static_cast<short>(bits));
+            else if constexpr (sizeof(T) == 4)
+                return _mm_set1_epi32(static_cast<int>(bits));
+            else
+                return _mm_set1_epi64x(bits);
+        }
+
+        // all ones in the lanes that are equal.
+        template <typename T>
+        HTK_TARGET("sse2")
+        __m128i equal_sse2(__m128i items, __m128i value)
+        {
+            if constexpr (htk::is_floating_point_v<T> && sizeof(T) == 4)
+                return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(items), _mm_castsi128_ps(value)));
+            else if constexpr (htk::is_floating_point_v<T>)
+                return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(items), _mm_castsi128_pd(value)));
+            else if constexpr (sizeof(T) == 1)
+                return _mm_cmpeq_epi8(items, value);
+            else if constexpr (sizeof(T) == 2)
+                return _mm_cmpeq_epi16(items, value);
+            else if constexpr (sizeof(T) == 4)
+                return _mm_cmpeq_epi32(items, value);
+            else
+            {
+                // no 64 bit compare before SSE4.1, both halves have to match.
+                const __m128i halves = _mm_cmpeq_epi32(items, value);
+                return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+        }
+
+        template <typename T>
+        HTK_TARGET("sse2")
+        unsigned int equal_mask_sse2(const T *p, __m128i value)
+        {
+            const __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            return static_cast<unsigned int>(_mm_movemask_epi8(equal_sse2<T>(items, value)));
+        }
+
+        template <typename T>
+        HTK_TARGET("sse2")
+        const T *find_sse2(const T *first, const T *last, T value)
+        {
+            constexpr ptrdiff_t lanes = 16 / sizeof(T);
+            const __m128i splat = splat_sse2(value);
+            for (; last - first >= lanes; first += lanes)
+            {
+                const unsigned int mask = equal_mask_sse2(first, splat);
+                if (mask != 0)
+                    return first + htk::countr_zero(mask) / sizeof(T);
+            }
+            return find_scalar(first, last, value);
+        }
+
+        template <typename T>
+        HTK_TARGET("sse2")
+        size_t count_sse2(const T *first, const T *last, T value)
+        {
+            constexpr ptrdiff_t lanes = 16 / sizeof(T);
+            const __m128i splat = splat_sse2(value);
+            size_t matched_bytes = 0;
+            for (; last - first >= lanes; first += lanes)
+                matched_bytes += htk::popcount(equal_mask_sse2(first, splat));
+            return matched_bytes / sizeof(T) + count_scalar(first, last, value);
+        }
+
+        template <typename T>
+        HTK_TARGET("sse2")
+        const T *find_any_sse2(const T *first, const T *last, const T *needles, size_t needle_count)
+        {
+            constexpr ptrdiff_t lanes = 16 / sizeof(T);
+            __m128i splats[max_simd_needles];
+            for (size_t n = 0; n < needle_count; ++n)
+                splats[n] = splat_sse2(needles[n]);
+            for (; last - first >= lanes; first += lanes)
+            {
+                const __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                __m128i any = _mm_setzero_si128();
+                for (size_t n = 0; n < needle_count; ++n)
+                    any = _mm_or_si128(any, equal_sse2<T>(items, splats[n]));
+                const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(any));
+                if (mask != 0)
+                    return first + htk::countr_zero(mask) / sizeof(T);
+            }
+            return find_any_scalar(first, last, needles, needle_count);
+        }
+
+        template <typename T>
+        HTK_TARGET("avx2")
+        __m256i splat_avx2(T value)
+        {
+            const auto bits = splat_bits(value);
+            if constexpr (sizeof(T) == 1)
+                return _mm256_set1_epi8(static_cast<char>(bits));
+            else if constexpr (sizeof(T) == 2)
+                return _mm256_set1_epi16(static_cast<short>(bits));
+            else if constexpr (sizeof(T) == 4)
+                return _mm256_set1_epi32(static_cast<int>(bits));
+            else
+                return _mm256_set1_epi64x(bits);
+        }
+
+        template <typename T>
+        HTK_TARGET("avx2")
+        __m256i equal_avx2(__m256i items, __m256i value)
+        {
+            if constexpr (htk::is_floating_point_v<T> && sizeof(T) == 4)
+                return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(items), _mm256_castsi256_ps(value), _CMP_EQ_OQ));
+            else if constexpr (htk::is_floating_point_v<T>)
+                return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(items), _mm256_castsi256_pd(value), _CMP_EQ_OQ));
+            else if constexpr (sizeof(T) == 1)
+                return _mm256_cmpeq_epi8(items, value);
+            else if constexpr (sizeof(T) == 2)
+                return _mm256_cmpeq_epi16(items, value);
+            else if constexpr (sizeof(T) == 4)
+                return _mm256_cmpeq_epi32(items, value);
+            else
+                return _mm256_cmpeq_epi64(items, value);
+        }
+
+        template <typename T>
+        HTK_TARGET("avx2")
+        unsigned int equal_mask_avx2(const T *p, __m256i value)
+        {
+            const __m256i items = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            return static_cast<unsigned int>(_mm256_movemask_epi8(equal_avx2<T>(items, value)));
+        }
+
+        // two registers, a cache line, a step.
+        template <typename T>
+        HTK_TARGET("avx2")
+        const T *find_avx2(const T *first, const T *last, T value)
+        {
+            constexpr ptrdiff_t lanes = 32 / sizeof(T);
+            const __m256i splat = splat_avx2(value);
+            for (; last - first >= 2 * lanes; first += 2 * lanes)
+            {
+                const unsigned int low = equal_mask_avx2(first, splat);
+                const unsigned int high = equal_mask_avx2(first + lanes, splat);
+                if ((low | high) != 0)
+                    return low != 0 ? first + htk::countr_zero(low) / sizeof(T) : first + lanes + htk::countr_zero(high) / sizeof(T);
+            }
+            for (; last - first >= lanes; first += lanes)
+            {
+                const unsigned int mask = equal_mask_avx2(first, splat);
+                if (mask != 0)
+                    return first + htk::countr_zero(mask) / sizeof(T);
+            }
+            return find_scalar(first, last, value);
+        }
+
+        template <typename T>
+        HTK_TARGET("avx2")
+        size_t count_avx2(const T *first, const T *last, T value)
+        {
+            constexpr ptrdiff_t lanes = 32 / sizeof(T);
+            const __m256i splat = splat_avx2(value);
+            size_t matched_bytes = 0;
+            for (; last - first >= lanes; first += lanes)
+                matched_bytes += htk::popcount(equal_mask_avx2(first, splat));
+            return matched_bytes / sizeof(T) + count_scalar(first, last, value);
+        }
+
+        template <typename T>
+        HTK_TARGET("avx2")
+        const T *find_any_avx2(const T *first, const T *last, const T *needles, size_t needle_count)
+        {
+            constexpr ptrdiff_t lanes = 32 / sizeof(T);
+            __m256i splats[max_simd_needles];
+            for (size_t n = 0; n < needle_count; ++n)
+                splats[n] = splat_avx2(needles[n]);
+            for (; last - first >= 2 * lanes; first += 2 * lanes)
+            {
+                const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + lanes));
+                __m256i any_low = _mm256_setzero_si256();
+                __m256i any_high = _mm256_setzero_si256();
+                for (size_t n = 0; n < needle_count; ++n)
+                {
+                    any_low = _mm256_or_si256(any_low, equal_avx2<T>(low, splats[n]));
+                    any_high = _mm256_or_si256(any_high, equal_avx2<T>(high, splats[n]));
+                }
+                const auto low_mask = static_cast<unsigned int>(_mm256_movemask_epi8(any_low));
+                const auto high_mask = static_cast<unsigned int>(_mm256_movemask_epi8(any_high));
+                if ((low_mask | high_mask) != 0)
+                    return low_mask != 0 ? first + htk::countr_zero(low_mask) / sizeof(T) : first + lanes + htk::countr_zero(high_mask) / sizeof(T);
+            }
+            for (; last - first >= lanes; first += lanes)
+            {
+                const __m256i items = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                __m256i any = _mm256_setzero_si256();
+                for (size_t n = 0; n < needle_count; ++n)
+                    any = _mm256_or_si256(any, equal_avx2<T>(items, splats[n]));
+                const auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(any));
+                if (mask != 0)
+                    return first + htk::countr_zero(mask) / sizeof(T);
+            }
+            return find_any_scalar(first, last, needles, needle_count);
+        }
+#endif
+
+        template <typename T>
+        const T *find(const T *first, const T *last, T value)
+        {
+#if HTK_X86
+            if (cpu().avx2)
+                return find_avx2(first, last, value);
+            if (cpu().sse2)
+                return find_sse2(first, last, value);
+#endif
+            return find_scalar(first, last, value);
+        }
+
+        template <typename T>
+        size_t count(const T *first, const T *last, T value)
+        {
+#if HTK_X86
+            if (cpu().avx2)
+                return count_avx2(first, last, value);
+            if (cpu().sse2)
+                return count_sse2(first, last, value);
+#endif
+            return count_scalar(first, last, value);
+        }
+
+        template <typename T>
+        const T *find_any(const T *first, const T *last, const T *needles, size_t needle_count)
+        {
+#if HTK_X86
+            if (needle_count <= max_simd_needles)
+            {
+                if (cpu().avx2)
+                    return find_any_avx2(first, last, needles, needle_count);
+                if (cpu().sse2)
+                    return find_any_sse2(first, last, needles, needle_count);
+            }
+#endif
+            return find_any_scalar(first, last, needles, needle_count);
+        }
+
+        /*
+            Word kernels for bitvector. bitwise() combines src into dst a
+            register at a time, find_word_not() skips the words equal to skip
+            (0 when looking for a set bit, ~0 for an unset one) a register at
+            a time and returns the first that isn't, or last.
+        */
+        enum class bit_op
+        {
+            and_,
+            or_,
+            xor_
+        };
+
+        template <bit_op Op, typename T>
+        inline T apply_bit_op(T lhs, T rhs)
+        {
+            if constexpr (Op == bit_op::and_)
+                return lhs & rhs;
+            else if constexpr (Op == bit_op::or_)
+                return lhs | rhs;
+            else
+                return lhs ^ rhs;
+        }
+
+        template <bit_op Op>
+        void bitwise_scalar(uint64_t *dst, const uint64_t *src, size_t words)
+        {
+            for (size_t i = 0; i < words; ++i)
+                dst[i] = apply_bit_op<Op>(dst[i], src[i]);
+        }
+
+        inline const uint64_t *find_word_not_scalar(const uint64_t *first, const uint64_t *last, uint64_t skip)
+        {
+            while (first != last && *first == skip)
+                ++first;
+            return first;
+        }
+
+#if HTK_X86
+        template <bit_op Op>
+        HTK_TARGET("sse2")
+        void bitwise_sse2(uint64_t *dst, const uint64_t *src, size_t words)
+        {
+            size_t i = 0;
+            for (; i + 2 <= words; i += 2)
+            {
+                const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+                const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                __m128i out;
+                if constexpr (Op == bit_op::and_)
+                    out = _mm_and_si128(l, r);
+                else if constexpr (Op == bit_op::or_)
+                    out = _mm_or_si128(l, r);
+                else
+                    out = _mm_xor_si128(l, r);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), out);
+            }
+            bitwise_scalar<Op>(dst + i, src + i, words - i);
+        }
+
+        template <bit_op Op>
+        HTK_TARGET("avx2")
+        void bitwise_avx2(uint64_t *dst, const uint64_t *src, size_t words)
+        {
+            size_t i = 0;
+            for (; i + 4 <= words; i += 4)
+            {
+                const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+                const __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                __m256i out;
+                if constexpr (Op == bit_op::and_)
+                    out = _mm256_and_si256(l, r);
+                else if constexpr (Op == bit_op::or_)
+                    out = _mm256_or_si256(l, r);
+                else
+                    out = _mm256_xor_si256(l, r);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), out);
+            }
+            bitwise_scalar<Op>(dst + i, src + i, words - i);
+        }
+
+        HTK_TARGET("sse2")
+        inline const uint64_t *find_word_not_sse2(const uint64_t *first, const uint64_t *last, uint64_t skip)
+        {
+            const __m128i skips = _mm_set1_epi64x(static_cast<long long>(skip));
+            for (; last - first >= 2; first += 2)
+            {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(words, skips)) != 0xFFFF)
+                    break;
+            }
+            return find_word_not_scalar(first, last, skip);
+        }
+
+        HTK_TARGET("avx2")
+        inline const uint64_t *find_word_not_avx2(const uint64_t *first, const uint64_t *last, uint64_t skip)
+        {
+            const __m256i skips = _mm256_set1_epi64x(static_cast<long long>(skip));
+            for (; last - first >= 4; first += 4)
+            {
+                const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+                if (static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(words, skips))) != 0xFFFFFFFFu)
+                    break;
+            }
+            return find_word_not_scalar(first, last, skip);
+        }
+#endif
+
+        template <bit_op Op>
+        void bitwise(uint64_t *dst, const uint64_t *src, size_t words)
+        {
+#if HTK_X86
+            if (cpu().avx2)
+                return bitwise_avx2<Op>(dst, src, words);
+            if (cpu().sse2)
+                return bitwise_sse2<Op>(dst, src, words);
+#endif
+            bitwise_scalar<Op>(dst, src, words);
+        }
+
+        inline const uint64_t *find_word_not(const uint64_t *first, const uint64_t *last, uint64_t skip)
+        {
+#if HTK_X86
+            if (cpu().avx2)
+                return find_word_not_avx2(first, last, skip);
+            if (cpu().sse2)
+                return find_word_not_sse2(first, last, skip);
+#endif
+            return find_word_not_scalar(first, last, skip);
+        }
+    }
+}
+
+#endif // __htk_detail_simd_h__
@@ -0,0 +1,215 @@
+#ifndef __htk_huge_page_allocator_h__
+#define __htk_huge_page_allocator_h__
+
+#include <htk/memory.h>
+
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace htk
+{
+    namespace detail
+    {
+        /*
+            Page mapping for the huge page allocator. Every block is rounded up
+            to whole huge pages, on the way in and on the way out, so the size
+            the caller hands back is all that's needed to unmap it.
+
+            Windows only gives out large pages to a process holding
+            SeLockMemoryPrivilege, without it we get ordinary pages from
+            VirtualAlloc. Linux only has explicit huge pages if some have been
+            reserved (vm.nr_hugepages), otherwise we map 2MB aligned memory and
+            ask for transparent huge pages with madvise.
+
+            Byte counts are the platform's size_t, not htk::size_t, which is
+            32 bits and would cut a multi-GB block down to what's left over.
+        */
+        struct huge_pages
+        {
+            using byte_count = std::size_t;
+
+            static constexpr byte_count default_size = 2 * 1024 * 1024;
+
+            static byte_count page_size()
+            {
+#ifdef _WIN32
+                static const byte_count size = ::GetLargePageMinimum() != 0 ? ::GetLargePageMinimum() : default_size;
+                return size;
+#else
+                return default_size;
+#endif
+            }
+
+            static byte_count round_up(byte_count bytes)
+            {
+                const byte_count page = page_size();
+                // room to round up, and for the extra page map_transparent takes.
+                if (bytes > byte_count(-1) - 2 * page)
+                    throw bad_alloc();
+                return (bytes + page - 1) / page * page;
+            }
+
+            static void *map(byte_count bytes)
+            {
+                const byte_count size = round_up(bytes);
+#ifdef _WIN32
+                void *p = ::VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if (p == nullptr)
+                    p = ::VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+                if (p == nullptr)
+                    throw bad_alloc();
+                return p;
+#else
+#ifdef MAP_HUGETLB
+                void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p != MAP_FAILED)
+                    return p;
+#endif
+                return map_transparent(size);
+#endif
+            }
+
+            static void unmap(void *p, byte_count bytes)
+            {
+#ifdef _WIN32
+                ::VirtualFree(p, 0, MEM_RELEASE);
+#else
+                ::munmap(p, round_up(bytes));
+#endif
+            }
+
+#ifndef _WIN32
+            // over maps by a page, and trims either side so the block is
+            // aligned to one. THP can only back aligned 2MB ranges.
+            static void *map_transparent(byte_count size)
+            {
+                const byte_count page = page_size();
+                void *raw = ::mmap(nullptr, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (raw == MAP_FAILED)
+                    throw bad_alloc();
+
+                char *first = static_cast<char *>(raw);
+                char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(first) + page - 1) & ~(uintptr_t(page) - 1));
+                if (aligned != first)
+                    ::munmap(first, aligned - first);
+                const byte_count tail = (first + size + page) - (aligned + size);
+                if (tail != 0)
+                    ::munmap(aligned + size, tail);
+#ifdef MADV_HUGEPAGE
+                ::madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+                return aligned;
+            }
+#endif
+        };
+    }
+
+    /*
+        An allocator for very big vectors. Anything of Threshold bytes or
+        more is mapped straight from the OS on huge pages, when it'll give us
+        them, so a multi-GB table needs a few thousand TLB entries rather
+        than a million. Anything smaller goes to htk::allocator, rounding it
+        up to a huge page would be a waste.
+    */
+    template <typename T, size_t Threshold = detail::huge_pages::default_size>
+    struct huge_page_allocator
+    {
+        using value_type = typename htk::remove_cvref_t<T>;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        static constexpr size_t threshold = Threshold;
+
+        huge_page_allocator() = default;
+
+        template <typename U>
+        huge_page_allocator(const huge_page_allocator<U, Threshold> &)
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            if (!is_huge(count))
+                return small_.allocate(count);
+            return static_cast<pointer>(detail::huge_pages::map(bytes(count)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (!is_huge(n))
+                small_.deallocate(p, n);
+            else if (p != nullptr)
+                detail::huge_pages::unmap(p, bytes(n));
+        }
+
+        // see allocator::reallocate. a huge block that still fits in its
+        // pages just stays where it is.
+        pointer reallocate(pointer p, size_type n, size_type count)
+        {
+            if (!is_huge(n) && !is_huge(count))
+                return small_.reallocate(p, n, count);
+            if (is_huge(n) && is_huge(count) &&
+                detail::huge_pages::round_up(bytes(n)) == detail::huge_pages::round_up(bytes(count)))
+                return p;
+
+            const pointer fresh = allocate(count);
+            if (p != nullptr)
+                memcpy(fresh, p, bytes(htk::min(n, count)));
+            deallocate(p, n);
+            return fresh;
+        }
+
+        static bool is_huge(size_type count)
+        {
+            return bytes(count) >= Threshold;
+        }
+
+        static detail::huge_pages::byte_count bytes(size_type count)
+        {
+            return detail::huge_pages::byte_count(count) * sizeof(T);
+        }
+
+        size_type max_size() const
+        {
+            return max(size_type(1), size_type(UINT_MAX / sizeof(T)));
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            ::new (static_cast<void*>(&dest)) T(htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            p->~T();
+        }
+
+    private:
+        htk::allocator<T> small_;
+    };
+
+    template <typename T, typename U, size_t Threshold>
+    bool operator==(const huge_page_allocator<T, Threshold> &l, const huge_page_allocator<U, Threshold> &r)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, size_t Threshold>
+    bool operator!=(const huge_page_allocator<T, Threshold> &l, const huge_page_allocator<U, Threshold> &r)
+    {
+        return false;
+    }
+}
+
+#endif // __htk_huge_page_allocator_h__
@@ -0,0 +1,455 @@
+#ifndef __htk_inplace_vector_h__
+#define __htk_inplace_vector_h__
+
+#include <htk/algorithm.h>
+#include <htk/exception.h>
+#include <htk/initializer_list.h>
+#include <htk/iterator.h>
+#include <htk/stdexcept.h>
+#include <htk/type_traits.h>
+#include <htk/utility.h>
+
+#include <new>
+
+namespace htk
+{
+    namespace detail
+    {
+        /*
+            The items of an inplace_vector, and how many there are. Trivial
+            types get a plain array, which copies, moves and goes away
+            trivially, and can be used in a constant expression. Everything
+            else gets raw bytes, constructed into as items are added.
+        */
+        template <typename T, size_t N, bool Trivial = htk::is_trivial_v<T>>
+        struct inplace_storage
+        {
+            constexpr T *items() noexcept { return items_; }
+            constexpr const T *items() const noexcept { return items_; }
+
+            T items_[N]{};
+            size_t size_ = 0;
+        };
+
+        template <typename T, size_t N>
+        struct inplace_storage<T, N, false>
+        {
+            inplace_storage() noexcept
+                : size_(0)
+            {
+            }
+
+            inplace_storage(const inplace_storage &rhs)
+                : size_(0)
+            {
+                for (; size_ < rhs.size_; ++size_)
+                    ::new (static_cast<void *>(items() + size_)) T(rhs.items()[size_]);
+            }
+
+            inplace_storage(inplace_storage &&rhs)
+                : size_(0)
+            {
+                for (; size_ < rhs.size_; ++size_)
+                    ::new (static_cast<void *>(items() + size_)) T(htk::move(rhs.items()[size_]));
+            }
+
+            inplace_storage &operator=(const inplace_storage &rhs)
+            {
+                if (this != &rhs)
+                    assign<false>(rhs);
+                return *this;
+            }
+
+            inplace_storage &operator=(inplace_storage &&rhs)
+            {
+                if (this != &rhs)
+                    assign<true>(rhs);
+                return *this;
+            }
+
+            ~inplace_storage()
+            {
+                destroy_from(0);
+            }
+
+            T *items() noexcept { return reinterpret_cast<T *>(buffer_); }
+            const T *items() const noexcept { return reinterpret_cast<const T *>(buffer_); }
+
+            void destroy_from(size_t count) noexcept
+            {
+                while (size_ > count)
+                    items()[--size_].~T();
+            }
+
+            // assigns over the items we have, constructs the rest.
+            template <bool Move, typename StorageT>
+            void assign(StorageT &rhs)
+            {
+                using source = typename htk::conditional<Move, T &&, const T &>::type;
+                const size_t count = rhs.size_;
+                for (size_t i = 0; i < count && i < size_; ++i)
+                    items()[i] = static_cast<source>(rhs.items()[i]);
+                destroy_from(count);
+                for (; size_ < count; ++size_)
+                    ::new (static_cast<void *>(items() + size_)) T(static_cast<source>(rhs.items()[size_]));
+            }
+
+            alignas(T) unsigned char buffer_[N * sizeof(T)];
+            size_t size_;
+        };
+    }
+
+    /*
+        A vector that never allocates. Room for N items lives inside the
+        object, the way an array's does, and running out of it is an error
+        rather than a reason to grow: push_back and friends throw bad_alloc,
+        try_push_back and try_emplace_back return nullptr instead.
+
+        The rest is htk::vector's interface, with N as the fixed capacity.
+        Iterators are plain pointers. Inserting in the middle appends and
+        then rotates into place, so if building an item throws, the items
+        already added are left at the end.
+
+        For trivial types the storage is a plain array, so the whole thing
+        is a literal type, and can be built and used in a constant
+        expression:
+
+            constexpr auto ports = [] {
+                htk::inplace_vector<int, 4> v;
+                v.push_back(80);
+                v.push_back(443);
+                return v;
+            }();
+    */
+    template <typename T, size_t N>
+    class inplace_vector : private detail::inplace_storage<T, N>
+    {
+        static_assert(N > 0, "inplace_vector needs room for at least one item");
+        using base = detail::inplace_storage<T, N>;
+        using base::items;
+        using base::size_;
+
+        static constexpr bool trivial = htk::is_trivial_v<T>;
+
+    public:
+        using value_type = T;
+        using reference = T &;
+        using const_reference = const T &;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using iterator = T *;
+        using const_iterator = const T *;
+        using difference_type = htk::ptrdiff_t;
+        using size_type = htk::size_t;
+
+        static constexpr size_t max_capacity = N;
+
+        constexpr inplace_vector() = default;
+
+        constexpr inplace_vector(const htk::initializer_list<T> &init)
+        {
+            if (init.size() > N)
+                throw bad_alloc("inplace_vector is full");
+            for (const auto &item : init)
+                unchecked_emplace_back(item);
+        }
+
+    public: // modifiers
+        template <typename... Args>
+        constexpr T &emplace_back(Args &&... args)
+        {
+            if (full())
+                throw bad_alloc("inplace_vector is full");
+            return unchecked_emplace_back(htk::forward<Args>(args)...);
+        }
+
+        constexpr void push_back(const T &item)
+        {
+            emplace_back(item);
+        }
+
+        constexpr void push_back(T &&item)
+        {
+            emplace_back(htk::move(item));
+        }
+
+        // nullptr when full, the new item otherwise.
+        template <typename... Args>
+        constexpr T *try_emplace_back(Args &&... args)
+        {
+            if (full())
+                return nullptr;
+            return &unchecked_emplace_back(htk::forward<Args>(args)...);
+        }
+
+        constexpr T *try_push_back(const T &item)
+        {
+            return try_emplace_back(item);
+        }
+
+        constexpr T *try_push_back(T &&item)
+        {
+            return try_emplace_back(htk::move(item));
+        }
+
+        // the caller has checked there's room.
+        template <typename... Args>
+        constexpr T &unchecked_emplace_back(Args &&... args)
+        {
+            T *p = items() + size_;
+            construct(p, htk::forward<Args>(args)...);
+            ++size_;
+            return *p;
+        }
+
+        template <typename... Args>
+        constexpr iterator emplace(const_iterator where, Args &&... args)
+        {
+            if (full())
+                throw bad_alloc("inplace_vector is full");
+            const auto offset = where - begin();
+            unchecked_emplace_back(htk::forward<Args>(args)...);
+            return rotate_in(offset, size_ - 1);
+        }
+
+        constexpr iterator insert(const_iterator where, size_type count, const T &value)
+        {
+            reserve(size_ + count);
+            const auto offset = where - begin();
+            const auto old_size = size_;
+            for (size_type i = 0; i < count; ++i)
+                unchecked_emplace_back(value);
+            return rotate_in(offset, old_size);
+        }
+
+        // The source iterators must not point into this vector.
+        template <typename It, typename = htk::enable_if_t<htk::is_iterator_v<It>>>
+        constexpr iterator insert(const_iterator where, It start, It fin)
+        {
+            check_room(start, fin, htk::iterator_category_t<It>{});
+            const auto offset = where - begin();
+            const auto old_size = size_;
+            for (; start != fin; ++start)
+                emplace_back(*start);
+            return rotate_in(offset, old_size);
+        }
+
+        constexpr iterator insert(const_iterator where, const htk::initializer_list<T> &init)
+        {
+            return insert(where, init.begin(), init.end());
+        }
+
+        template <typename RangeT>
+        constexpr void append_range(RangeT &&range)
+        {
+            insert(end(), range.begin(), range.end());
+        }
+
+        constexpr void clear()
+        {
+            truncate(0);
+        }
+
+        constexpr iterator erase(const_iterator where)
+        {
+            return erase(where, where + 1);
+        }
+
+        constexpr iterator erase(const_iterator first, const_iterator last)
+        {
+            const pointer dest = begin() + (first - begin());
+            const pointer src = begin() + (last - begin());
+            if (dest != src)
+            {
+                pointer out = dest;
+                for (pointer in = src; in != end(); ++in, ++out)
+                    *out = htk::move(*in);
+                truncate(static_cast<size_type>(out - begin()));
+            }
+            return dest;
+        }
+
+        constexpr void pop_back()
+        {
+            if (empty())
+                throw htk::exception("pop_back() called on empty inplace_vector");
+            truncate(size_ - 1);
+        }
+
+        constexpr void resize(size_type count)
+        {
+            reserve(count);
+            truncate(count);
+            while (size_ < count)
+                unchecked_emplace_back();
+        }
+
+        constexpr void resize(size_type count, const T &value)
+        {
+            // the value could be one of the items about to go.
+            const T copy{ value };
+            reserve(count);
+            truncate(count);
+            while (size_ < count)
+                unchecked_emplace_back(copy);
+        }
+
+    public: // access
+        constexpr T &back()
+        {
+            if (empty())
+                throw htk::exception("back() called on empty inplace_vector");
+            return items()[size_ - 1];
+        }
+
+        constexpr const T &back() const
+        {
+            if (empty())
+                throw htk::exception("back() called on empty inplace_vector");
+            return items()[size_ - 1];
+        }
+
+        constexpr T &at(size_type index)
+        {
+            if (index >= size_)
+                throw out_of_range("index out of range");
+            return items()[index];
+        }
+
+        constexpr const T &at(size_type index) const
+        {
+            if (index >= size_)
+                throw out_of_range("index out of range");
+            return items()[index];
+        }
+
+        constexpr T *data() noexcept
+        {
+            return items();
+        }
+
+        constexpr const T *data() const noexcept
+        {
+            return items();
+        }
+
+        constexpr const_iterator cbegin() const { return items(); }
+        constexpr const_iterator cend() const { return items() + size_; }
+        constexpr iterator begin() { return items(); }
+        constexpr iterator end() { return items() + size_; }
+        constexpr const_iterator begin() const { return items(); }
+        constexpr const_iterator end() const { return items() + size_; }
+
+    public: // capacity
+        constexpr size_t freespace() const
+        {
+            return N - size_;
+        }
+
+        // nothing to reserve, but asking for more than N is the same error
+        // as running out.
+        constexpr void reserve(size_type count)
+        {
+            if (count > N)
+                throw bad_alloc("inplace_vector is full");
+        }
+
+        constexpr void shrink_to_fit()
+        {
+        }
+
+        static constexpr size_t capacity() noexcept
+        {
+            return N;
+        }
+
+        constexpr size_t size() const
+        {
+            return size_;
+        }
+
+        constexpr bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        constexpr bool full() const
+        {
+            return size_ == N;
+        }
+
+    private:
+        template <typename... Args>
+        static constexpr void construct(pointer p, Args &&... args)
+        {
+            // assignment for trivial types, placement new isn't allowed in a
+            // constant expression.
+            if constexpr (trivial)
+                *p = T(htk::forward<Args>(args)...);
+            else
+                ::new (static_cast<void *>(p)) T(htk::forward<Args>(args)...);
+        }
+
+        constexpr void truncate(size_type count)
+        {
+            if constexpr (trivial)
+            {
+                if (count < size_)
+                    size_ = count;
+            }
+            else
+                base::destroy_from(count);
+        }
+
+        // a range we can measure fails before adding anything.
+        template <typename It>
+        constexpr void check_room(It, It, htk::input_iterator_tag)
+        {
+        }
+
+        template <typename It>
+        constexpr void check_room(It start, It fin, htk::forward_iterator_tag)
+        {
+            reserve(size_ + static_cast<size_type>(htk::distance(start, fin)));
+        }
+
+        // moves the items appended from old_size on down to offset, the
+        // ones in between up past them. returns the first one moved down.
+        constexpr iterator rotate_in(difference_type offset, size_t old_size)
+        {
+            const pointer first = begin() + offset;
+            const pointer middle = begin() + old_size;
+            reverse(first, middle);
+            reverse(middle, end());
+            reverse(first, end());
+            return first;
+        }
+
+        static constexpr void reverse(pointer first, pointer last)
+        {
+            for (; last - first > 1; ++first)
+            {
+                --last;
+                T tmp(htk::move(*first));
+                *first = htk::move(*last);
+                *last = htk::move(tmp);
+            }
+        }
+    };
+
+    template <typename T, size_t N, typename PredT>
+    constexpr typename inplace_vector<T, N>::size_type erase_if(inplace_vector<T, N> &v, PredT pred)
+    {
+        const auto size = v.size();
+        v.erase(htk::remove_if(v.begin(), v.end(), pred), v.end());
+        return static_cast<typename inplace_vector<T, N>::size_type>(size - v.size());
+    }
+
+    template <typename T, size_t N, typename ValueT>
+    constexpr typename inplace_vector<T, N>::size_type erase(inplace_vector<T, N> &v, const ValueT &value)
+    {
+        return htk::erase_if(v, [&value](const T &item) { return item == value; });
+    }
+}
+
+#endif // __htk_inplace_vector_h__
@@ -80,10 +80,59 @@ namespace htk
     template <typename Iterator>
     constexpr bool is_iterator_v = has_iterator_cat_v<Iterator>;
 
+    template <typename IteratorT>
+    using iterator_category_t = typename iterator_traits<IteratorT>::iterator_category;
+
     namespace detail
     {
         template <typename IteratorT>
-        typename iterator_traits<IteratorT>::pointer undress(IteratorT &&t);
+        typename iterator_traits<IteratorT>::difference_type distance(IteratorT first, IteratorT last, input_iterator_tag)
+        {
+            typename iterator_traits<IteratorT>::difference_type count = 0;
+            for (; first != last; ++first)
+                ++count;
+            return count;
+        }
+
+        template <typename IteratorT>
+        typename iterator_traits<IteratorT>::difference_type distance(IteratorT first, IteratorT last, random_access_iterator_tag)
+        {
+            return last - first;
+        }
+    }
+
+    template <typename IteratorT>
+    typename iterator_traits<IteratorT>::difference_type distance(IteratorT first, IteratorT last)
+    {
+        return detail::distance(first, last, iterator_category_t<IteratorT>{});
+    }
+
+    /*
+        Contiguous iterators walk memory laid out like an array, so a range of
+        them can be treated as a pointer and a length. Pointers are, and
+        containers specialize this for their own iterators, along with an
+        undress() overload that hands back the pointer.
+    */
+    template <typename IteratorT>
+    struct is_contiguous_iterator : false_type
+    {
+    };
+
+    template <typename T>
+    struct is_contiguous_iterator<T *> : true_type
+    {
+    };
+
+    template <typename IteratorT>
+    constexpr bool is_contiguous_iterator_v = is_contiguous_iterator<remove_cvref_t<IteratorT>>::value;
+
+    namespace detail
+    {
+        template <typename T>
+        T *undress(T *t)
+        {
+            return t;
+        }
     }
 };
 
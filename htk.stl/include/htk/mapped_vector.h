@@ -0,0 +1,468 @@
+#ifndef __htk_mapped_vector_h__
+#define __htk_mapped_vector_h__
+
+#include <htk/exception.h>
+#include <htk/stdexcept.h>
+#include <htk/type_traits.h>
+#include <htk/vector.h>
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace htk
+{
+    enum class map_mode
+    {
+        read_only,
+        read_write
+    };
+
+    namespace detail
+    {
+        /*
+            A file, and one view of it. map() replaces the view with one of
+            a new length, and when the file is writable grows the file to
+            match. The old view is gone after a map(), anything pointing into
+            it is left dangling, but only once the new one exists: when map()
+            throws, the old view is still there, and so is everything in it.
+        */
+        class mapped_file
+        {
+        public:
+            mapped_file(const char *path, map_mode mode)
+                : mode_(mode), view_(nullptr), view_bytes_(0)
+            {
+#ifdef _WIN32
+                const DWORD access = mode == map_mode::read_only ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+                const DWORD disposition = mode == map_mode::read_only ? OPEN_EXISTING : OPEN_ALWAYS;
+                file_ = ::CreateFileA(path, access, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file_ == INVALID_HANDLE_VALUE)
+                    throw htk::exception("could not open the mapped file");
+                mapping_ = nullptr;
+#else
+                file_ = mode == map_mode::read_only ? ::open(path, O_RDONLY) : ::open(path, O_RDWR | O_CREAT, 0644);
+                if (file_ == -1)
+                    throw htk::exception("could not open the mapped file");
+#endif
+            }
+
+            mapped_file(const mapped_file &) = delete;
+            mapped_file &operator=(const mapped_file &) = delete;
+
+            ~mapped_file()
+            {
+                unmap();
+#ifdef _WIN32
+                ::CloseHandle(file_);
+#else
+                ::close(file_);
+#endif
+            }
+
+            uint64_t file_size() const
+            {
+#ifdef _WIN32
+                LARGE_INTEGER size;
+                if (!::GetFileSizeEx(file_, &size))
+                    throw htk::exception("could not size the mapped file");
+                return static_cast<uint64_t>(size.QuadPart);
+#else
+                struct stat st;
+                if (::fstat(file_, &st) != 0)
+                    throw htk::exception("could not size the mapped file");
+                return static_cast<uint64_t>(st.st_size);
+#endif
+            }
+
+            void *map(uint64_t bytes)
+            {
+                if (bytes == 0)
+                {
+                    unmap();
+                    return nullptr;
+                }
+#ifdef _WIN32
+                // a read write mapping longer than the file grows the file.
+                const DWORD protect = mode_ == map_mode::read_only ? PAGE_READONLY : PAGE_READWRITE;
+                const HANDLE mapping = ::CreateFileMappingA(file_, nullptr, protect, static_cast<DWORD>(bytes >> 32),
+                                                            static_cast<DWORD>(bytes), nullptr);
+                if (mapping == nullptr)
+                    throw htk::exception("could not map the file");
+                const DWORD access = mode_ == map_mode::read_only ? FILE_MAP_READ : FILE_MAP_WRITE;
+                void *view = ::MapViewOfFile(mapping, access, 0, 0, static_cast<SIZE_T>(bytes));
+                if (view == nullptr)
+                {
+                    ::CloseHandle(mapping);
+                    throw htk::exception("could not map the file");
+                }
+                unmap();
+                mapping_ = mapping;
+#else
+                // growing the file leaves the current view as it was.
+                if (mode_ == map_mode::read_write && file_size() < bytes)
+                    resize(bytes);
+                const int protect = mode_ == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+                void *view = ::mmap(nullptr, static_cast<size_t>(bytes), protect, MAP_SHARED, file_, 0);
+                if (view == MAP_FAILED)
+                    throw htk::exception("could not map the file");
+                unmap();
+#endif
+                view_ = view;
+                view_bytes_ = bytes;
+                return view_;
+            }
+
+            void unmap()
+            {
+                if (view_ == nullptr)
+                    return;
+#ifdef _WIN32
+                ::UnmapViewOfFile(view_);
+                ::CloseHandle(mapping_);
+                mapping_ = nullptr;
+#else
+                ::munmap(view_, static_cast<size_t>(view_bytes_));
+#endif
+                view_ = nullptr;
+                view_bytes_ = 0;
+            }
+
+            // cuts the file back to bytes, which the view has to fit in.
+            // Windows won't change the length of a file with a view open, so
+            // there the file keeps its slack until it's unmapped.
+            void trim(uint64_t bytes)
+            {
+#ifdef _WIN32
+                if (view_ != nullptr)
+                    return;
+#endif
+                resize(bytes);
+            }
+
+            // sets the length of the file. only valid with nothing mapped
+            // past the new end.
+            void resize(uint64_t bytes)
+            {
+#ifdef _WIN32
+                LARGE_INTEGER size;
+                size.QuadPart = static_cast<LONGLONG>(bytes);
+                if (!::SetFilePointerEx(file_, size, nullptr, FILE_BEGIN) || !::SetEndOfFile(file_))
+                    throw htk::exception("could not resize the mapped file");
+#else
+                if (::ftruncate(file_, static_cast<off_t>(bytes)) != 0)
+                    throw htk::exception("could not resize the mapped file");
+#endif
+            }
+
+            // writes dirty pages back to the file, and waits for it.
+            void flush()
+            {
+                if (view_ == nullptr)
+                    return;
+#ifdef _WIN32
+                ::FlushViewOfFile(view_, 0);
+                ::FlushFileBuffers(file_);
+#else
+                ::msync(view_, static_cast<size_t>(view_bytes_), MS_SYNC);
+#endif
+            }
+
+            map_mode mode() const
+            {
+                return mode_;
+            }
+
+        private:
+            map_mode mode_;
+#ifdef _WIN32
+            HANDLE file_;
+            HANDLE mapping_;
+#else
+            int file_;
+#endif
+            void *view_;
+            uint64_t view_bytes_;
+        };
+    }
+
+    /*
+        A vector whose storage is a file. The file is the items, in memory
+        order with nothing else in it, so opening one is a mapping rather than
+        a load: a read_only open of a table written earlier costs a page
+        fault per page actually touched, and nothing more.
+
+        Growth follows GrowthT like the vector's, except it's the file that
+        grows (ftruncate / SetEndOfFile) and is then mapped again. Slack past
+        size() lives in the file too until the vector goes away, when the
+        file is cut back to size().
+
+        Only for trivially copyable T, the bytes are all there is. Any member
+        that modifies a read_only vector throws invalid_operation, but a
+        write through at() or an iterator is a write to a read only page,
+        and faults.
+    */
+    template <typename T, typename GrowthT = htk::page_growth<>>
+    class mapped_vector
+    {
+        static_assert(htk::is_trivially_copyable_v<T>, "mapped_vector needs a trivially copyable type");
+
+        template <typename>
+        friend class vector_iterator;
+
+    public:
+        using value_type = T;
+        using reference = T &;
+        using const_reference = const T &;
+        using checked_iterator = vector_iterator<mapped_vector>;
+        using unchecked_iterator = vector_unchecked_iterator<mapped_vector>;
+        using iterator = typename htk::conditional<HTK_ITERATOR_CHECKS, checked_iterator, unchecked_iterator>::type;
+        using const_iterator = const iterator;
+        using difference_type = htk::ptrdiff_t;
+        using size_type = htk::size_t;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using growth_policy = GrowthT;
+
+        mapped_vector(const char *path, map_mode mode = map_mode::read_write)
+            : file_(path, mode), data_{ nullptr, nullptr, nullptr }
+        {
+            const auto count = static_cast<size_type>(file_.file_size() / sizeof(T));
+            if (count == 0)
+                return;
+            const pointer first = static_cast<pointer>(file_.map(uint64_t(count) * sizeof(T)));
+            data_ = storage{ first, first + count, first + count };
+        }
+
+        mapped_vector(const mapped_vector &) = delete;
+        mapped_vector &operator=(const mapped_vector &) = delete;
+
+        ~mapped_vector()
+        {
+            if (read_only())
+                return;
+            const auto bytes = uint64_t(size()) * sizeof(T);
+            file_.unmap();
+            try
+            {
+                file_.resize(bytes);
+            }
+            catch (...)
+            {
+                // the items are all there, the file just keeps its slack.
+            }
+        }
+
+    public: // modifiers
+        template <typename... Args>
+        T &emplace_back(Args &&... args)
+        {
+            ensure_space_at_least(1);
+            ::new (static_cast<void *>(data_.last)) T(htk::forward<Args>(args)...);
+            return *(data_.last++);
+        }
+
+        void push_back(const T &item)
+        {
+            emplace_back(item);
+        }
+
+        void pop_back()
+        {
+            check_writable();
+            if (empty())
+                throw htk::exception("pop_back() called on empty mapped_vector");
+            --data_.last;
+        }
+
+        void clear()
+        {
+            check_writable();
+            data_.last = data_.first;
+        }
+
+        void resize(size_type count)
+        {
+            resize(count, T{});
+        }
+
+        void resize(size_type count, const T &value)
+        {
+            check_writable();
+            if (count > capacity())
+                remap(count);
+            for (pointer p = data_.last; p < data_.first + count; ++p)
+                ::new (static_cast<void *>(p)) T(value);
+            data_.last = data_.first + count;
+        }
+
+        // all the items in one go, the file grows at most once.
+        template <typename It>
+        void append(It first, It last)
+        {
+            const auto count = static_cast<size_type>(htk::distance(first, last));
+            ensure_space_at_least(count);
+            for (; first != last; ++first)
+                ::new (static_cast<void *>(data_.last++)) T(*first);
+        }
+
+        // writes everything back to the file, now rather than eventually.
+        void flush()
+        {
+            file_.flush();
+        }
+
+    public: // access
+        T &back()
+        {
+            if (empty())
+                throw htk::exception("back() called on empty mapped_vector");
+            return *(data_.last - 1);
+        }
+
+        const T &back() const
+        {
+            if (empty())
+                throw htk::exception("back() called on empty mapped_vector");
+            return *(data_.last - 1);
+        }
+
+        T &at(size_type index)
+        {
+            if (data_.last <= data_.first + index)
+                throw out_of_range("index out of range");
+            return *(data_.first + index);
+        }
+
+        const T &at(size_type index) const
+        {
+            if (data_.last <= data_.first + index)
+                throw out_of_range("index out of range");
+            return *(data_.first + index);
+        }
+
+        T *data() noexcept
+        {
+            return data_.first;
+        }
+
+        const T *data() const noexcept
+        {
+            return data_.first;
+        }
+
+        const_iterator cbegin() const
+        {
+            return iterator(data_.first, this);
+        }
+
+        const_iterator cend() const
+        {
+            return iterator(data_.last, this);
+        }
+
+        iterator begin()
+        {
+            return iterator(data_.first, this);
+        }
+
+        iterator end()
+        {
+            return iterator(data_.last, this);
+        }
+
+    public: // capacity
+        void reserve(size_type count)
+        {
+            check_writable();
+            if (count > capacity())
+                remap(count);
+        }
+
+        void shrink_to_fit()
+        {
+            check_writable();
+            if (capacity() == size())
+                return;
+            const auto count = size();
+            remap_exactly(count, count);
+            file_.trim(uint64_t(count) * sizeof(T));
+        }
+
+        size_t capacity() const noexcept
+        {
+            return data_.end_of_container - data_.first;
+        }
+
+        size_t size() const
+        {
+            return data_.last - data_.first;
+        }
+
+        size_t freespace() const
+        {
+            return data_.end_of_container - data_.last;
+        }
+
+        bool empty() const
+        {
+            return data_.first == data_.last;
+        }
+
+        bool read_only() const
+        {
+            return file_.mode() == map_mode::read_only;
+        }
+
+    private:
+        struct storage
+        {
+            pointer first;
+            pointer last;
+            pointer end_of_container;
+        };
+
+        void check_writable() const
+        {
+            if (read_only())
+                throw invalid_operation("mapped_vector is read only");
+        }
+
+        void ensure_space_at_least(size_type count)
+        {
+            check_writable();
+            if (freespace() >= count)
+                return;
+            const auto cap = static_cast<size_type>(GrowthT::next(capacity(), size() + count, sizeof(T)));
+            remap(htk::max(cap, size() + count));
+        }
+
+        void remap(size_type cap)
+        {
+            remap_exactly(size(), cap);
+        }
+
+        // data_ only changes once the new view is there, a map that throws
+        // leaves the vector as it was.
+        void remap_exactly(size_type count, size_type cap)
+        {
+            const pointer first = static_cast<pointer>(file_.map(uint64_t(cap) * sizeof(T)));
+            data_ = storage{ first, first + count, first + cap };
+        }
+
+        detail::mapped_file file_;
+        storage data_;
+    };
+}
+
+#endif // __htk_mapped_vector_h__
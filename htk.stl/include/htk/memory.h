@@ -1,10 +1,19 @@
 #ifndef __htk_memory_h__
 #define __htk_memory_h__
 
+#include <htk/bit.h>
 #include <htk/types.h>
 #include <htk/utility.h>
 #include <htk/exception.h>
 
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <xmemory>
 
 namespace htk
@@ -47,19 +56,35 @@ namespace htk
             return &x;
         }
 
+        // malloc rather than ::operator new, so that the block can later be
+        // handed to realloc.
         pointer allocate(size_t count)
         {
-            T* temp = static_cast<T*>(::operator new(count*sizeof(T)));
-            if (temp == nullptr)
+            T* temp = static_cast<T*>(::malloc(count*sizeof(T)));
+            if (temp == nullptr && count != 0)
             {
                 throw bad_alloc();
             }
             return temp;
         }
 
-        void deallocate(pointer p, size_type n)
+        void deallocate(pointer p, size_type)
+        {
+            ::free(p);
+        }
+
+        // Resizes a block from allocate, moving its bytes if it has to. Only
+        // valid for types that can be moved with a memcpy. The CRT gets to grow
+        // the block in place, or for large blocks remap the pages, so neither
+        // the copy nor the second buffer is a given.
+        pointer reallocate(pointer p, size_type, size_type count)
         {
-            ::operator delete(p, n * sizeof(T));
+            T* temp = static_cast<T*>(::realloc(static_cast<void *>(p), count*sizeof(T)));
+            if (temp == nullptr && count != 0)
+            {
+                throw bad_alloc();
+            }
+            return temp;
         }
 
         size_type max_size() const
@@ -85,6 +110,84 @@ namespace htk
         using pointer = void*;
     };
 
+    // true when an allocator has reallocate(p, n, count).
+    template <typename AllocatorT, typename = void>
+    struct allocator_can_reallocate : false_type
+    {
+    };
+
+    template <typename AllocatorT>
+    struct allocator_can_reallocate<AllocatorT, void_t<decltype(htk::declval<AllocatorT &>().reallocate(
+        htk::declval<typename AllocatorT::pointer>(), size_t(), size_t()))>> : true_type
+    {
+    };
+
+    template <typename AllocatorT>
+    constexpr bool allocator_can_reallocate_v = allocator_can_reallocate<AllocatorT>::value;
+
+    /*
+        What a container needs to know about an allocator, beyond allocate and
+        deallocate. Allocators only have to declare the parts that differ from
+        the defaults: nothing propagates, and an allocator is always equal to
+        another of its type when it has no state.
+    */
+    namespace detail
+    {
+        template <typename AllocatorT, typename = void>
+        struct pocca : false_type {};
+
+        template <typename AllocatorT>
+        struct pocca<AllocatorT, void_t<typename AllocatorT::propagate_on_container_copy_assignment>>
+            : AllocatorT::propagate_on_container_copy_assignment {};
+
+        template <typename AllocatorT, typename = void>
+        struct pocma : false_type {};
+
+        template <typename AllocatorT>
+        struct pocma<AllocatorT, void_t<typename AllocatorT::propagate_on_container_move_assignment>>
+            : AllocatorT::propagate_on_container_move_assignment {};
+
+        template <typename AllocatorT, typename = void>
+        struct always_equal : bool_constant<is_empty_v<AllocatorT>> {};
+
+        template <typename AllocatorT>
+        struct always_equal<AllocatorT, void_t<typename AllocatorT::is_always_equal>>
+            : AllocatorT::is_always_equal {};
+
+        template <typename AllocatorT, typename = void>
+        struct has_select_on_copy : false_type {};
+
+        template <typename AllocatorT>
+        struct has_select_on_copy<AllocatorT, void_t<decltype(htk::declval<const AllocatorT &>().select_on_container_copy_construction())>>
+            : true_type {};
+    }
+
+    template <typename AllocatorT>
+    struct allocator_traits
+    {
+        using allocator_type = AllocatorT;
+        using propagate_on_container_copy_assignment = detail::pocca<AllocatorT>;
+        using propagate_on_container_move_assignment = detail::pocma<AllocatorT>;
+        using is_always_equal = detail::always_equal<AllocatorT>;
+
+        static AllocatorT select_on_container_copy_construction(const AllocatorT &a)
+        {
+            if constexpr (detail::has_select_on_copy<AllocatorT>::value)
+                return a.select_on_container_copy_construction();
+            else
+                return a;
+        }
+
+        // whether memory from one can be handed back to the other.
+        static bool equal(const AllocatorT &l, const AllocatorT &r)
+        {
+            if constexpr (is_always_equal::value)
+                return true;
+            else
+                return l == r;
+        }
+    };
+
     template <typename T, typename U>
     bool operator==(const allocator<T> &l, const allocator<U> &r)
     {
@@ -96,7 +199,1159 @@ namespace htk
     {
         return !operator==(l,r);
     }
+
+    /*
+        A monotonic arena. Memory is carved off the front of a chunk by bumping
+        a cursor, and nothing is given back until release(), or the arena dies,
+        when every chunk goes at once. It's meant for the things built and
+        thrown away together, like everything a request handler makes.
+
+        Each new chunk is twice the last, so the number of mallocs is the log
+        of the total. It can start on a buffer the caller owns, a stack array
+        say, in which case small workloads never malloc at all.
+
+        It's not thread safe, an arena belongs to whoever is doing the work.
+    */
+    class arena
+    {
+        struct chunk
+        {
+            chunk *next;
+            size_t size;
+        };
+
+    public:
+        static constexpr size_t default_chunk_size = 4096;
+
+        explicit arena(size_t chunk_size = default_chunk_size)
+            : arena(nullptr, 0, chunk_size)
+        {
+        }
+
+        arena(void *buffer, size_t size, size_t chunk_size = default_chunk_size)
+            : initial_(static_cast<char *>(buffer)), initial_size_(size), chunk_size_(chunk_size),
+              next_chunk_size_(chunk_size), chunks_(nullptr), last_(nullptr),
+              cursor_(initial_), end_(initial_ + size)
+        {
+        }
+
+        arena(const arena &) = delete;
+        arena &operator=(const arena &) = delete;
+
+        ~arena()
+        {
+            release();
+        }
+
+        void *allocate(size_t bytes, size_t align)
+        {
+            char *p = align_up(cursor_, align);
+            // the padding alone can run past the end of the chunk.
+            if (cursor_ == nullptr || p > end_ || bytes > static_cast<size_t>(end_ - p))
+            {
+                add_chunk(bytes + align);
+                p = align_up(cursor_, align);
+            }
+            last_ = p;
+            cursor_ = p + bytes;
+            return p;
+        }
+
+        // only the most recent allocation can be given back, anything else
+        // waits for release().
+        void deallocate(void *p, size_t bytes)
+        {
+            if (p == last_ && static_cast<char *>(p) + bytes == cursor_)
+            {
+                cursor_ = static_cast<char *>(p);
+                last_ = nullptr;
+            }
+        }
+
+        // the most recent allocation can grow or shrink where it is, if the
+        // chunk has the room. otherwise it's allocate and copy, and the old
+        // block is just left behind.
+        void *reallocate(void *p, size_t old_bytes, size_t bytes, size_t align)
+        {
+            if (p == nullptr)
+                return allocate(bytes, align);
+            if (p == last_ && bytes <= static_cast<size_t>(end_ - static_cast<char *>(p)))
+            {
+                cursor_ = static_cast<char *>(p) + bytes;
+                return p;
+            }
+            void *fresh = allocate(bytes, align);
+            memcpy(fresh, p, htk::min(old_bytes, bytes));
+            return fresh;
+        }
+
+        // frees every chunk, and starts over on the caller's buffer.
+        void release()
+        {
+            while (chunks_ != nullptr)
+            {
+                chunk *next = chunks_->next;
+                ::free(chunks_);
+                chunks_ = next;
+            }
+            next_chunk_size_ = chunk_size_;
+            last_ = nullptr;
+            cursor_ = initial_;
+            end_ = initial_ + initial_size_;
+        }
+
+        // how much is left in the current chunk.
+        size_t available() const
+        {
+            return cursor_ < end_ ? static_cast<size_t>(end_ - cursor_) : 0;
+        }
+
+    private:
+        static char *align_up(char *p, size_t align)
+        {
+            const auto bits = reinterpret_cast<uintptr_t>(p);
+            return reinterpret_cast<char *>((bits + align - 1) & ~(uintptr_t(align) - 1));
+        }
+
+        void add_chunk(size_t at_least)
+        {
+            const size_t size = htk::max(next_chunk_size_, at_least);
+            chunk *c = static_cast<chunk *>(::malloc(sizeof(chunk) + size));
+            if (c == nullptr)
+                throw bad_alloc();
+            c->next = chunks_;
+            c->size = size;
+            chunks_ = c;
+            next_chunk_size_ = size * 2;
+            cursor_ = reinterpret_cast<char *>(c + 1);
+            end_ = cursor_ + size;
+        }
+
+        char *const initial_;
+        const size_t initial_size_;
+        const size_t chunk_size_;
+        size_t next_chunk_size_;
+        chunk *chunks_;
+        void *last_;
+        char *cursor_;
+        char *end_;
+    };
+
+    /*
+        An allocator that carves from an htk::arena. It holds a pointer to the
+        arena, so the arena has to outlive anything using it. Deallocate is
+        (nearly) free, and reallocate can extend a growing vector in place
+        when it was the last thing allocated.
+    */
+    template <typename T>
+    struct arena_allocator
+    {
+        using value_type = typename htk::remove_cvref_t<T>;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        using is_always_equal = false_type;
+
+        arena_allocator(htk::arena &a)
+            : arena_(&a)
+        {
+        }
+
+        template <typename U>
+        arena_allocator(const arena_allocator<U> &rhs)
+            : arena_(rhs.resource())
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            return static_cast<pointer>(arena_->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            arena_->deallocate(p, n * sizeof(T));
+        }
+
+        // see allocator::reallocate, only for types that move with a memcpy.
+        pointer reallocate(pointer p, size_type n, size_type count)
+        {
+            return static_cast<pointer>(arena_->reallocate(p, n * sizeof(T), count * sizeof(T), alignof(T)));
+        }
+
+        size_type max_size() const
+        {
+            return max(size_type(1), size_type(UINT_MAX / sizeof(T)));
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            ::new (static_cast<void*>(&dest)) T(htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            p->~T();
+        }
+
+        htk::arena *resource() const
+        {
+            return arena_;
+        }
+
+    private:
+        htk::arena *arena_;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const arena_allocator<T> &l, const arena_allocator<U> &r)
+    {
+        return l.resource() == r.resource();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const arena_allocator<T> &l, const arena_allocator<U> &r)
+    {
+        return !operator==(l, r);
+    }
+
+    namespace detail
+    {
+        // power of two size classes, 16 bytes to 32k. anything bigger than
+        // the largest isn't pooled.
+        struct pool_size_classes
+        {
+            static constexpr size_t count = 12;
+            static constexpr size_t smallest = 16;
+            static constexpr size_t largest = smallest << (count - 1);
+
+            static size_t index(size_t bytes)
+            {
+                return bytes <= smallest ? 0 : static_cast<size_t>(htk::bit_width(bytes - 1)) - 4;
+            }
+
+            static size_t size(size_t index)
+            {
+                return smallest << index;
+            }
+        };
+
+        struct pool_block
+        {
+            pool_block *next;
+        };
+
+        /*
+            The depot every thread shares. Thread caches take blocks from it,
+            and give them back, a batch at a time under the class's lock. A
+            block freed on a different thread from the one that allocated it
+            goes into the freeing thread's cache, and from there back here
+            when that cache overflows.
+
+            When a class runs dry a fresh slab is carved up for it. Slabs are
+            never handed back to the system.
+        */
+        class pool_depot
+        {
+        public:
+            static constexpr size_t batch_size = 32;
+            static constexpr size_t slab_size = 64 * 1024;
+
+            static pool_depot &instance()
+            {
+                static pool_depot depot;
+                return depot;
+            }
+
+            // a chain of up to batch_size blocks, count is set to its length.
+            pool_block *take(size_t index, size_t &count)
+            {
+                auto &c = classes_[index];
+                std::lock_guard<std::mutex> lock(c.mutex);
+                if (c.free == nullptr)
+                    carve(index, c);
+
+                pool_block *tail = c.free;
+                count = 1;
+                while (count < batch_size && tail->next != nullptr)
+                {
+                    tail = tail->next;
+                    ++count;
+                }
+                pool_block *head = c.free;
+                c.free = tail->next;
+                tail->next = nullptr;
+                return head;
+            }
+
+            void give(size_t index, pool_block *head, pool_block *tail)
+            {
+                auto &c = classes_[index];
+                std::lock_guard<std::mutex> lock(c.mutex);
+                tail->next = c.free;
+                c.free = head;
+            }
+
+        private:
+            struct size_class
+            {
+                std::mutex mutex;
+                pool_block *free = nullptr;
+            };
+
+            void carve(size_t index, size_class &c)
+            {
+                const size_t block = pool_size_classes::size(index);
+                const size_t blocks = htk::max(slab_size / block, batch_size);
+                char *slab = static_cast<char *>(::malloc(blocks * block));
+                if (slab == nullptr)
+                    throw bad_alloc();
+
+                pool_block *head = nullptr;
+                for (size_t i = blocks; i-- > 0;)
+                {
+                    auto b = reinterpret_cast<pool_block *>(slab + i * block);
+                    b->next = head;
+                    head = b;
+                }
+                c.free = head;
+            }
+
+            size_class classes_[pool_size_classes::count];
+        };
+
+        /*
+            A thread's own free lists, one per class. Allocate and deallocate
+            only ever touch these, the depot's lock is taken when a list runs
+            out, or grows past two batches.
+        */
+        class pool_cache
+        {
+        public:
+            static pool_cache &local()
+            {
+                thread_local pool_cache cache;
+                return cache;
+            }
+
+            pool_cache() = default;
+            pool_cache(const pool_cache &) = delete;
+            pool_cache &operator=(const pool_cache &) = delete;
+
+            // everything goes back to the depot when the thread ends.
+            ~pool_cache()
+            {
+                for (size_t i = 0; i < pool_size_classes::count; ++i)
+                {
+                    if (lists_[i].head != nullptr)
+                        flush(i, lists_[i].count);
+                }
+            }
+
+            void *allocate(size_t index)
+            {
+                auto &l = lists_[index];
+                if (l.head == nullptr)
+                    l.head = pool_depot::instance().take(index, l.count);
+                pool_block *b = l.head;
+                l.head = b->next;
+                --l.count;
+                return b;
+            }
+
+            void deallocate(void *p, size_t index)
+            {
+                auto &l = lists_[index];
+                auto b = static_cast<pool_block *>(p);
+                b->next = l.head;
+                l.head = b;
+                if (++l.count > 2 * pool_depot::batch_size)
+                    flush(index, pool_depot::batch_size);
+            }
+
+        private:
+            // gives the first count blocks of a list back to the depot.
+            void flush(size_t index, size_t count)
+            {
+                auto &l = lists_[index];
+                pool_block *head = l.head;
+                pool_block *tail = head;
+                for (size_t i = 1; i < count; ++i)
+                    tail = tail->next;
+                l.head = tail->next;
+                l.count -= count;
+                pool_depot::instance().give(index, head, tail);
+            }
+
+            struct free_list
+            {
+                pool_block *head = nullptr;
+                size_t count = 0;
+            };
+
+            free_list lists_[pool_size_classes::count];
+        };
+    }
+
+    /*
+        An allocator backed by size class free lists, with a cache per thread
+        in front of a shared depot. The common allocate and deallocate are a
+        pop or a push on a thread local list, no lock and no malloc.
+
+        It has no state, any two compare equal, and memory from one thread can
+        be freed on any other.
+    */
+    template <typename T>
+    struct pool_allocator
+    {
+        using value_type = typename htk::remove_cvref_t<T>;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+
+        pool_allocator() = default;
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U> &)
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            const size_t bytes = count * sizeof(T);
+            if (bytes > detail::pool_size_classes::largest)
+            {
+                T *temp = static_cast<T *>(::malloc(bytes));
+                if (temp == nullptr)
+                    throw bad_alloc();
+                return temp;
+            }
+            return static_cast<pointer>(detail::pool_cache::local().allocate(detail::pool_size_classes::index(bytes)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (p == nullptr)
+                return;
+            const size_t bytes = n * sizeof(T);
+            if (bytes > detail::pool_size_classes::largest)
+                ::free(p);
+            else
+                detail::pool_cache::local().deallocate(p, detail::pool_size_classes::index(bytes));
+        }
+
+        size_type max_size() const
+        {
+            return max(size_type(1), size_type(UINT_MAX / sizeof(T)));
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            ::new (static_cast<void*>(&dest)) T(htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            p->~T();
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const pool_allocator<T> &l, const pool_allocator<U> &r)
+    {
+        return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const pool_allocator<T> &l, const pool_allocator<U> &r)
+    {
+        return false;
+    }
+
+    /*
+        Polymorphic memory resources, after std::pmr. A memory_resource is
+        where the bytes come from, chosen at runtime, and polymorphic_allocator
+        is the one allocator type that hands out from any of them. So an
+        htk::vector<T, htk::polymorphic_allocator<T>> is the same type whatever
+        backs it, at the cost of a virtual call per allocation.
+    */
+    class memory_resource
+    {
+    public:
+        static constexpr size_t max_align = alignof(max_align_t);
+
+        virtual ~memory_resource() = default;
+
+        void *allocate(size_t bytes, size_t align = max_align)
+        {
+            return do_allocate(bytes, align);
+        }
+
+        void deallocate(void *p, size_t bytes, size_t align = max_align)
+        {
+            do_deallocate(p, bytes, align);
+        }
+
+        bool is_equal(const memory_resource &rhs) const noexcept
+        {
+            return do_is_equal(rhs);
+        }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t align) = 0;
+        virtual void do_deallocate(void *p, size_t bytes, size_t align) = 0;
+        virtual bool do_is_equal(const memory_resource &rhs) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource &l, const memory_resource &r)
+    {
+        return &l == &r || l.is_equal(r);
+    }
+
+    inline bool operator!=(const memory_resource &l, const memory_resource &r)
+    {
+        return !(l == r);
+    }
+
+    namespace detail
+    {
+        class new_delete_resource : public memory_resource
+        {
+        protected:
+            void *do_allocate(size_t bytes, size_t align) override
+            {
+                if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    return ::operator new(bytes, std::align_val_t(align));
+                return ::operator new(bytes);
+            }
+
+            void do_deallocate(void *p, size_t, size_t align) override
+            {
+                if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                    ::operator delete(p, std::align_val_t(align));
+                else
+                    ::operator delete(p);
+            }
+
+            bool do_is_equal(const memory_resource &rhs) const noexcept override
+            {
+                return this == &rhs;
+            }
+        };
+
+        inline std::atomic<memory_resource *> &default_resource()
+        {
+            static std::atomic<memory_resource *> resource{ nullptr };
+            return resource;
+        }
+    }
+
+    // global operator new and delete, the default default resource.
+    inline memory_resource *new_delete_resource() noexcept
+    {
+        static detail::new_delete_resource resource;
+        return &resource;
+    }
+
+    inline memory_resource *get_default_resource() noexcept
+    {
+        memory_resource *r = detail::default_resource().load();
+        return r != nullptr ? r : new_delete_resource();
+    }
+
+    // returns the previous default. nullptr puts back new_delete_resource().
+    inline memory_resource *set_default_resource(memory_resource *r) noexcept
+    {
+        memory_resource *previous = detail::default_resource().exchange(r);
+        return previous != nullptr ? previous : new_delete_resource();
+    }
+
+    // an htk::arena behind the memory_resource interface.
+    class monotonic_buffer_resource : public memory_resource
+    {
+    public:
+        explicit monotonic_buffer_resource(size_t chunk_size = arena::default_chunk_size)
+            : arena_(chunk_size)
+        {
+        }
+
+        monotonic_buffer_resource(void *buffer, size_t size, size_t chunk_size = arena::default_chunk_size)
+            : arena_(buffer, size, chunk_size)
+        {
+        }
+
+        void release()
+        {
+            arena_.release();
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t align) override
+        {
+            return arena_.allocate(bytes, align);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t) override
+        {
+            arena_.deallocate(p, bytes);
+        }
+
+        bool do_is_equal(const memory_resource &rhs) const noexcept override
+        {
+            return this == &rhs;
+        }
+
+    private:
+        htk::arena arena_;
+    };
+
+    /*
+        Free lists per size class (the pool_allocator's classes), carved out
+        of chunks from the upstream resource. Nothing goes back upstream until
+        release(), or the pool dies. Requests bigger than the largest class,
+        or more aligned than max_align, go upstream one by one, but are still
+        tracked so that release() gets them too.
+
+        As the name says, there's no locking.
+    */
+    class unsynchronized_pool_resource : public memory_resource
+    {
+        using classes = detail::pool_size_classes;
+
+        struct chunk
+        {
+            chunk *next;
+            size_t bytes;
+        };
+
+        // lives in front of a block from upstream, in a slot of `align` bytes.
+        struct large_block
+        {
+            large_block *prev;
+            large_block *next;
+            size_t bytes;
+            size_t align;
+        };
+
+    public:
+        static constexpr size_t max_chunk_size = 64 * 1024;
+
+        explicit unsynchronized_pool_resource(memory_resource *upstream = get_default_resource())
+            : upstream_(upstream), chunks_(nullptr), large_(nullptr)
+        {
+            for (size_t i = 0; i < classes::count; ++i)
+            {
+                free_[i] = nullptr;
+                next_blocks_[i] = 8;
+            }
+        }
+
+        unsynchronized_pool_resource(const unsynchronized_pool_resource &) = delete;
+        unsynchronized_pool_resource &operator=(const unsynchronized_pool_resource &) = delete;
+
+        ~unsynchronized_pool_resource()
+        {
+            release();
+        }
+
+        void release()
+        {
+            while (chunks_ != nullptr)
+            {
+                chunk *next = chunks_->next;
+                upstream_->deallocate(chunks_, chunks_->bytes);
+                chunks_ = next;
+            }
+            while (large_ != nullptr)
+            {
+                large_block *next = large_->next;
+                upstream_->deallocate(reinterpret_cast<char *>(large_) - header_offset(large_->align),
+                                      large_->bytes, large_->align);
+                large_ = next;
+            }
+            for (size_t i = 0; i < classes::count; ++i)
+            {
+                free_[i] = nullptr;
+                next_blocks_[i] = 8;
+            }
+        }
+
+        memory_resource *upstream_resource() const
+        {
+            return upstream_;
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t align) override
+        {
+            if (!pooled(bytes, align))
+                return allocate_large(bytes, align);
+
+            const size_t index = classes::index(bytes);
+            if (free_[index] == nullptr)
+                carve(index);
+            detail::pool_block *b = free_[index];
+            free_[index] = b->next;
+            return b;
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t align) override
+        {
+            if (!pooled(bytes, align))
+            {
+                deallocate_large(p);
+                return;
+            }
+            const size_t index = classes::index(bytes);
+            auto b = static_cast<detail::pool_block *>(p);
+            b->next = free_[index];
+            free_[index] = b;
+        }
+
+        bool do_is_equal(const memory_resource &rhs) const noexcept override
+        {
+            return this == &rhs;
+        }
+
+    private:
+        static bool pooled(size_t bytes, size_t align)
+        {
+            return bytes <= classes::largest && align <= classes::smallest;
+        }
+
+        // the header is one slot before the block, so the block keeps its alignment.
+        static size_t header_offset(size_t align)
+        {
+            return ((sizeof(large_block) + align - 1) / align) * align - sizeof(large_block);
+        }
+
+        void *allocate_large(size_t bytes, size_t align)
+        {
+            align = htk::max(align, alignof(large_block));
+            const size_t slot = header_offset(align) + sizeof(large_block);
+            char *raw = static_cast<char *>(upstream_->allocate(slot + bytes, align));
+            auto header = reinterpret_cast<large_block *>(raw + header_offset(align));
+            header->prev = nullptr;
+            header->next = large_;
+            header->bytes = slot + bytes;
+            header->align = align;
+            if (large_ != nullptr)
+                large_->prev = header;
+            large_ = header;
+            return raw + slot;
+        }
+
+        void deallocate_large(void *p)
+        {
+            auto header = static_cast<large_block *>(p) - 1;
+            if (header->prev != nullptr)
+                header->prev->next = header->next;
+            else
+                large_ = header->next;
+            if (header->next != nullptr)
+                header->next->prev = header->prev;
+            upstream_->deallocate(reinterpret_cast<char *>(header) - header_offset(header->align),
+                                  header->bytes, header->align);
+        }
+
+        // each chunk for a class is twice the last, up to max_chunk_size.
+        void carve(size_t index)
+        {
+            const size_t block = classes::size(index);
+            const size_t blocks = next_blocks_[index];
+            if ((blocks * 2) * block <= max_chunk_size)
+                next_blocks_[index] = blocks * 2;
+
+            const size_t bytes = sizeof(chunk) + blocks * block;
+            auto c = static_cast<chunk *>(upstream_->allocate(bytes, classes::smallest));
+            c->next = chunks_;
+            c->bytes = bytes;
+            chunks_ = c;
+
+            char *first = reinterpret_cast<char *>(c + 1);
+            detail::pool_block *head = free_[index];
+            for (size_t i = blocks; i-- > 0;)
+            {
+                auto b = reinterpret_cast<detail::pool_block *>(first + i * block);
+                b->next = head;
+                head = b;
+            }
+            free_[index] = head;
+        }
+
+        memory_resource *upstream_;
+        chunk *chunks_;
+        large_block *large_;
+        detail::pool_block *free_[classes::count];
+        size_t next_blocks_[classes::count];
+    };
+
+    // the same pool, behind one lock.
+    class synchronized_pool_resource : public memory_resource
+    {
+    public:
+        explicit synchronized_pool_resource(memory_resource *upstream = get_default_resource())
+            : pool_(upstream)
+        {
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pool_.release();
+        }
+
+        memory_resource *upstream_resource() const
+        {
+            return pool_.upstream_resource();
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t align) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return pool_.allocate(bytes, align);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t align) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pool_.deallocate(p, bytes, align);
+        }
+
+        bool do_is_equal(const memory_resource &rhs) const noexcept override
+        {
+            return this == &rhs;
+        }
+
+    private:
+        std::mutex mutex_;
+        unsynchronized_pool_resource pool_;
+    };
+
+    /*
+        The allocator for any memory_resource, the default resource unless
+        told otherwise. Like std's, it doesn't propagate, and a copied
+        container goes back to the default resource.
+    */
+    template <typename T>
+    struct polymorphic_allocator
+    {
+        using value_type = typename htk::remove_cvref_t<T>;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        using is_always_equal = false_type;
+
+        polymorphic_allocator() noexcept
+            : resource_(get_default_resource())
+        {
+        }
+
+        polymorphic_allocator(memory_resource *r) noexcept
+            : resource_(r)
+        {
+        }
+
+        template <typename U>
+        polymorphic_allocator(const polymorphic_allocator<U> &rhs) noexcept
+            : resource_(rhs.resource())
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            return static_cast<pointer>(resource_->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (p != nullptr)
+                resource_->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        size_type max_size() const
+        {
+            return max(size_type(1), size_type(UINT_MAX / sizeof(T)));
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            ::new (static_cast<void*>(&dest)) T(htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            p->~T();
+        }
+
+        polymorphic_allocator select_on_container_copy_construction() const
+        {
+            return polymorphic_allocator();
+        }
+
+        memory_resource *resource() const
+        {
+            return resource_;
+        }
+
+    private:
+        memory_resource *resource_;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const polymorphic_allocator<T> &l, const polymorphic_allocator<U> &r)
+    {
+        return *l.resource() == *r.resource();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const polymorphic_allocator<T> &l, const polymorphic_allocator<U> &r)
+    {
+        return !operator==(l, r);
+    }
+
+    /*
+        What a counting_allocator saw. Nothing here is atomic, share a set of
+        counters between threads and the numbers will be off.
+
+        reallocations only counts calls to reallocate(), which htk::vector
+        makes for relocatable types when the allocator has one. Anything else
+        grows by allocate, copy and deallocate, which shows up as allocations,
+        and the reallocs counter isn't reported at all, rather than as a 0
+        that reads like the vector never grew.
+    */
+    struct allocation_counters
+    {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+        uint64_t reallocations = 0;
+        uint64_t bytes = 0;
+        uint64_t live = 0;
+        uint64_t peak_live = 0;
+        // set by an allocator that could have reallocated what it allocated.
+        bool counts_reallocations = false;
+
+        void reset()
+        {
+            *this = allocation_counters{};
+        }
+
+        void allocated(uint64_t size)
+        {
+            ++allocations;
+            bytes += size;
+            live += size;
+            if (live > peak_live)
+                peak_live = live;
+        }
+
+        void deallocated(uint64_t size)
+        {
+            ++deallocations;
+            live -= size;
+        }
+
+        void reallocated(uint64_t old_size, uint64_t size)
+        {
+            ++reallocations;
+            bytes += size > old_size ? size - old_size : 0;
+            live = live - old_size + size;
+            if (live > peak_live)
+                peak_live = live;
+        }
+    };
+
+    // hands each counter to fn(name, value), for whoever wants to report them.
+    template <typename Callable>
+    void for_each_counter(const allocation_counters &c, Callable &&fn)
+    {
+        fn("allocs", c.allocations);
+        if (c.counts_reallocations)
+            fn("reallocs", c.reallocations);
+        fn("bytes", c.bytes);
+        fn("peak live", c.peak_live);
+    }
+
+    /*
+        Wraps another allocator, and counts what goes through it into an
+        allocation_counters, which has to outlive it. It can reallocate when
+        the inner allocator can.
+    */
+    template <typename T, typename InnerT = htk::allocator<T>>
+    struct counting_allocator
+    {
+        using value_type = typename InnerT::value_type;
+        using pointer = typename InnerT::pointer;
+        using const_pointer = typename InnerT::const_pointer;
+        using reference = typename InnerT::reference;
+        using const_reference = typename InnerT::const_reference;
+        using size_type = typename InnerT::size_type;
+        using propagate_on_container_copy_assignment = typename allocator_traits<InnerT>::propagate_on_container_copy_assignment;
+        using propagate_on_container_move_assignment = typename allocator_traits<InnerT>::propagate_on_container_move_assignment;
+        using is_always_equal = false_type;
+
+        counting_allocator(allocation_counters &counters, const InnerT &inner = InnerT())
+            : counters_(&counters), inner_(inner)
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            const pointer p = inner_.allocate(count);
+            counters_->allocated(uint64_t(count) * sizeof(T));
+            if constexpr (allocator_can_reallocate_v<InnerT> && is_trivially_relocatable_v<T>)
+                counters_->counts_reallocations = true;
+            return p;
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (p != nullptr)
+                counters_->deallocated(uint64_t(n) * sizeof(T));
+            inner_.deallocate(p, n);
+        }
+
+        template <typename I = InnerT, typename = enable_if_t<allocator_can_reallocate_v<I>>>
+        pointer reallocate(pointer p, size_type n, size_type count)
+        {
+            const pointer fresh = inner_.reallocate(p, n, count);
+            counters_->reallocated(uint64_t(n) * sizeof(T), uint64_t(count) * sizeof(T));
+            return fresh;
+        }
+
+        size_type max_size() const
+        {
+            return inner_.max_size();
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            inner_.construct(dest, htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            inner_.destroy(p);
+        }
+
+        allocation_counters &counters() const
+        {
+            return *counters_;
+        }
+
+        const InnerT &inner() const
+        {
+            return inner_;
+        }
+
+    private:
+        allocation_counters *counters_;
+        InnerT inner_;
+    };
+
+    template <typename T, typename InnerT>
+    bool operator==(const counting_allocator<T, InnerT> &l, const counting_allocator<T, InnerT> &r)
+    {
+        return &l.counters() == &r.counters() && allocator_traits<InnerT>::equal(l.inner(), r.inner());
+    }
+
+    template <typename T, typename InnerT>
+    bool operator!=(const counting_allocator<T, InnerT> &l, const counting_allocator<T, InnerT> &r)
+    {
+        return !operator==(l, r);
+    }
+
+    // the line size on everything we run on, x64 and arm64 alike.
+    constexpr size_t cache_line_size = 64;
+
+    /*
+        An allocator whose blocks start on an Align byte boundary, a cache
+        line unless told otherwise. With PadToAlign, every block is also
+        rounded up to a whole number of Align, so it ends on a boundary too,
+        and nothing else can share its last line. That's what keeps
+        per-thread vectors from false sharing at their edges.
+    */
+    template <typename T, size_t Align = cache_line_size, bool PadToAlign = false>
+    struct aligned_allocator
+    {
+        static_assert((Align & (Align - 1)) == 0, "alignment must be a power of two");
+        static_assert(Align >= alignof(T), "alignment can't be less than the type's");
+
+        using value_type = typename htk::remove_cvref_t<T>;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        static constexpr size_t alignment = Align;
+
+        aligned_allocator() = default;
+
+        template <typename U>
+        aligned_allocator(const aligned_allocator<U, Align, PadToAlign> &)
+        {
+        }
+
+        pointer allocate(size_t count)
+        {
+            return static_cast<pointer>(::operator new(padded(count), std::align_val_t(Align)));
+        }
+
+        void deallocate(pointer p, size_type)
+        {
+            ::operator delete(p, std::align_val_t(Align));
+        }
+
+        // the bytes a block of count items really takes.
+        static size_t padded(size_t count)
+        {
+            const size_t bytes = count * sizeof(T);
+            if constexpr (PadToAlign)
+                return (bytes + Align - 1) & ~(Align - 1);
+            else
+                return bytes;
+        }
+
+        size_type max_size() const
+        {
+            return max(size_type(1), size_type(UINT_MAX / sizeof(T)));
+        }
+
+        template <typename ...Args>
+        void construct(reference dest, Args&&... args)
+        {
+            ::new (static_cast<void*>(&dest)) T(htk::forward<Args>(args)...);
+        }
+
+        void destroy(pointer p)
+        {
+            p->~T();
+        }
+    };
+
+    template <typename T, typename U, size_t Align, bool PadToAlign>
+    bool operator==(const aligned_allocator<T, Align, PadToAlign> &l, const aligned_allocator<U, Align, PadToAlign> &r)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, size_t Align, bool PadToAlign>
+    bool operator!=(const aligned_allocator<T, Align, PadToAlign> &l, const aligned_allocator<U, Align, PadToAlign> &r)
+    {
+        return false;
+    }
 }
 
 
-#endif // __htk_memory_h__
\ No newline at end of file
+#endif // __htk_memory_h__
@@ -0,0 +1,210 @@
+#ifndef __htk_radix_sort_h__
+#define __htk_radix_sort_h__
+
+#include <htk/iterator.h>
+#include <htk/type_traits.h>
+#include <htk/utility.h>
+#include <htk/vector.h>
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    A least significant digit radix sort for integer and floating point
+    keys. Rather than comparing items it deals them into buckets by one
+    digit of the key at a time, lowest digit first, each pass a read and a
+    write of every item, and each pass stable so the order of the digits
+    below survives the ones above. A handful of linear passes instead of
+    n log n compares with a branch the predictor can't learn.
+
+    32 and 64 bit keys go 11 bits a pass, 3 passes and 6, smaller keys a
+    byte. A pass where every key has the same digit would only copy the
+    items, so it's skipped: keys that all fit in 11 bits take one pass.
+
+    The sort is stable, and it needs somewhere to deal the items into, as
+    many again as are being sorted.
+*/
+
+namespace htk
+{
+    namespace detail
+    {
+        template <size_t Bytes>
+        struct radix_bits;
+
+        template <> struct radix_bits<1> { using type = uint8_t; };
+        template <> struct radix_bits<2> { using type = uint16_t; };
+        template <> struct radix_bits<4> { using type = uint32_t; };
+        template <> struct radix_bits<8> { using type = uint64_t; };
+
+        template <typename KeyT>
+        using radix_bits_t = typename radix_bits<sizeof(KeyT)>::type;
+
+        /*
+            The key as an unsigned number that sorts the same way. Signed
+            integers flip the sign bit, so the negatives come first. Floats
+            flip the sign bit of the positives and every bit of the
+            negatives, whose bits otherwise count up as the value goes down.
+            -0.0 sorts before 0.0, and NaNs go past the infinities, at the
+            end they're on by sign.
+        */
+        template <typename KeyT>
+        radix_bits_t<KeyT> radix_key(KeyT key)
+        {
+            static_assert(htk::is_arithmetic_v<KeyT>, "radix_sort sorts by an integer or floating point key");
+            using bits_type = radix_bits_t<KeyT>;
+            constexpr bits_type sign = bits_type(bits_type(1) << (sizeof(KeyT) * 8 - 1));
+
+            bits_type bits;
+            memcpy(&bits, &key, sizeof(bits));
+            if constexpr (htk::is_floating_point_v<KeyT>)
+                return bits ^ (bits & sign ? bits_type(~bits_type(0)) : sign);
+            else if constexpr (KeyT(-1) < KeyT(0))
+                return bits_type(bits ^ sign);
+            else
+                return bits;
+        }
+
+        struct radix_identity
+        {
+            template <typename T>
+            const T &operator()(const T &item) const
+            {
+                return item;
+            }
+        };
+
+        // under this many items an insertion sort beats clearing the counts.
+        constexpr size_t radix_sort_cutoff = 64;
+
+        template <typename IteratorT, typename KeyT>
+        void radix_insertion_sort(IteratorT first, size_t count, KeyT &key)
+        {
+            for (size_t i = 1; i < count; ++i)
+            {
+                auto item = htk::move(*(first + i));
+                const auto bits = radix_key(key(item));
+                size_t j = i;
+                for (; j > 0 && bits < radix_key(key(*(first + (j - 1)))); --j)
+                    *(first + j) = htk::move(*(first + (j - 1)));
+                *(first + j) = htk::move(item);
+            }
+        }
+
+        // deals count items from src into dst by the digit at shift, offsets
+        // being where each digit's items start.
+        template <typename SrcIt, typename DstIt, typename KeyT, typename BitsT>
+        void radix_scatter(SrcIt src, DstIt dst, size_t count, KeyT &key, unsigned shift, BitsT mask, size_t *offsets)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto digit = static_cast<size_t>((radix_key(key(*(src + i))) >> shift) & mask);
+                *(dst + offsets[digit]++) = htk::move(*(src + i));
+            }
+        }
+
+        // sorts the count items at data, using the count at scratch to deal
+        // into. Returns true when the sorted items are in scratch.
+        template <typename DataIt, typename ScratchIt, typename KeyT>
+        bool radix_sort_passes(DataIt data, ScratchIt scratch, size_t count, KeyT &key)
+        {
+            if (count <= radix_sort_cutoff)
+            {
+                radix_insertion_sort(data, count, key);
+                return false;
+            }
+
+            using key_type = htk::remove_cvref_t<decltype(key(*data))>;
+            using bits_type = radix_bits_t<key_type>;
+            constexpr unsigned key_bits = sizeof(key_type) * 8;
+            constexpr unsigned digit_bits = key_bits >= 32 ? 11 : 8;
+            constexpr unsigned passes = (key_bits + digit_bits - 1) / digit_bits;
+            constexpr size_t buckets = size_t(1) << digit_bits;
+            constexpr bits_type mask = bits_type(buckets - 1);
+
+            // every pass's counts from one read of the keys.
+            size_t counts[passes][buckets] = {};
+            for (size_t i = 0; i < count; ++i)
+            {
+                const bits_type bits = radix_key(key(*(data + i)));
+                for (unsigned pass = 0; pass < passes; ++pass)
+                    ++counts[pass][(bits >> (pass * digit_bits)) & mask];
+            }
+
+            const bits_type first_bits = radix_key(key(*data));
+            bool in_scratch = false;
+            for (unsigned pass = 0; pass < passes; ++pass)
+            {
+                const unsigned shift = pass * digit_bits;
+                size_t *offsets = counts[pass];
+                // everything has the first item's digit, nothing would move.
+                if (offsets[(first_bits >> shift) & mask] == count)
+                    continue;
+
+                size_t start = 0;
+                for (size_t digit = 0; digit < buckets; ++digit)
+                {
+                    const size_t n = offsets[digit];
+                    offsets[digit] = start;
+                    start += n;
+                }
+
+                if (in_scratch)
+                    radix_scatter(scratch, data, count, key, shift, mask, offsets);
+                else
+                    radix_scatter(data, scratch, count, key, shift, mask, offsets);
+                in_scratch = !in_scratch;
+            }
+            return in_scratch;
+        }
+    }
+
+    /*
+        Sorts [first, last) by key(item), which is an integer or a floating
+        point number, smallest first. Without a key the items are the keys.
+
+            htk::vector<uint64_t> scratch;
+            htk::radix_sort(ids.begin(), ids.end(), scratch);
+            htk::radix_sort(orders.begin(), orders.end(), order_scratch, [](const order &o) { return o.price; });
+
+        The items are dealt into scratch, which only grows, so a scratch
+        that's kept between sorts stops allocating once it's as big as the
+        biggest of them.
+    */
+    template <typename IteratorT, typename T, typename AllocatorT, typename GrowthT, typename KeyT = detail::radix_identity>
+    void radix_sort(IteratorT first, IteratorT last, htk::vector<T, AllocatorT, GrowthT> &scratch, KeyT key = KeyT{})
+    {
+        const auto count = static_cast<size_t>(last - first);
+        if (count > detail::radix_sort_cutoff && scratch.size() < count)
+            scratch.resize_default_init(count);
+        if (detail::radix_sort_passes(first, scratch.data(), count, key))
+        {
+            T *sorted = scratch.data();
+            for (size_t i = 0; i < count; ++i)
+                *(first + i) = htk::move(sorted[i]);
+        }
+    }
+
+    // the same, with a scratch of its own each time.
+    template <typename IteratorT, typename KeyT = detail::radix_identity>
+    void radix_sort(IteratorT first, IteratorT last, KeyT key = KeyT{})
+    {
+        htk::vector<typename iterator_traits<IteratorT>::value_type> scratch;
+        htk::radix_sort(first, last, scratch, key);
+    }
+
+    /*
+        The ping-pong form. data and scratch hold count items each, the
+        passes deal back and forth between them, and the sorted items are
+        left in whichever one the last pass wrote, which is returned. Nothing
+        is allocated or copied back, so code that sorts batch after batch
+        can keep two buffers and swap which one it calls data.
+    */
+    template <typename T, typename KeyT = detail::radix_identity>
+    T *radix_sort_ping_pong(T *data, T *scratch, size_t count, KeyT key = KeyT{})
+    {
+        return detail::radix_sort_passes(data, scratch, count, key) ? scratch : data;
+    }
+}
+
+#endif // __htk_radix_sort_h__
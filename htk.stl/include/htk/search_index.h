@@ -0,0 +1,264 @@
+#ifndef __htk_search_index_h__
+#define __htk_search_index_h__
+
+#include <htk/bit.h>
+#include <htk/detail/simd.h>
+#include <htk/iterator.h>
+#include <htk/memory.h>
+#include <htk/type_traits.h>
+#include <htk/vector.h>
+
+#include <limits>
+#include <stdint.h>
+
+/*
+    Read-only search structures over sorted data. Each one is built once
+    from a sorted range, a copy of the keys laid out so that a search touches
+    as few cache lines as possible, and answers the same questions as
+    lower_bound over the original.
+
+    A binary search over a big array is log2(n) cache misses, one per
+    level, and each one has to finish before the next address is known.
+    These put the keys a search visits next to each other instead.
+
+    Lookups hand back a pointer to the key inside the index, or nullptr when
+    there isn't one. The index doesn't know where the key was in the
+    original range.
+*/
+
+namespace htk
+{
+    /*
+        The keys in breadth first order, the layout of a binary heap: the
+        root at 1 and the children of k at 2k and 2k + 1. The first levels
+        of every search are the same few cache lines, which stay hot, and
+        the 16 descendants of k four levels down (for 4 byte keys) are one
+        line, at 16k. So each step prefetches that line, and by the time the
+        search gets there it has arrived.
+
+        The search itself is branchless, k = 2k + (key < x) down to a leaf,
+        then the trailing ones of k, the right turns taken since the last
+        left one, are shifted off to get back to the answer.
+    */
+    template <typename T>
+    class eytzinger_index
+    {
+    public:
+        using value_type = T;
+        using size_type = htk::size_t;
+        using const_pointer = const T *;
+
+        eytzinger_index()
+            : size_(0)
+        {
+        }
+
+        // [first, last) has to be sorted.
+        template <typename It, typename = htk::enable_if_t<htk::is_iterator_v<It>>>
+        eytzinger_index(It first, It last)
+            : size_(static_cast<size_type>(htk::distance(first, last)))
+        {
+            // slot 0 is never a key, it's where a search that runs off the
+            // right end lands.
+            tree_.resize(size_ + 1);
+            build(first, 1);
+        }
+
+        template <typename ContainerT, typename = decltype(htk::declval<const ContainerT &>().cbegin())>
+        explicit eytzinger_index(const ContainerT &sorted)
+            : eytzinger_index(sorted.cbegin(), sorted.cend())
+        {
+        }
+
+        // the first key not less than x.
+        const_pointer lower_bound(const T &x) const
+        {
+            return descend([&x](const T &key) { return key < x; });
+        }
+
+        // the first key greater than x.
+        const_pointer upper_bound(const T &x) const
+        {
+            return descend([&x](const T &key) { return !(x < key); });
+        }
+
+        const_pointer find(const T &x) const
+        {
+            const const_pointer found = lower_bound(x);
+            return found != nullptr && !(x < *found) ? found : nullptr;
+        }
+
+        bool contains(const T &x) const
+        {
+            return find(x) != nullptr;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+    private:
+        // keys per cache line, how far down a prefetch reaches.
+        static constexpr size_type line_keys = sizeof(T) < cache_line_size ? cache_line_size / sizeof(T) : 1;
+
+        // an in order walk of the tree is the sorted order.
+        template <typename It>
+        void build(It &it, size_type k)
+        {
+            if (k > size_)
+                return;
+            build(it, 2 * k);
+            tree_.data()[k] = *it;
+            ++it;
+            build(it, 2 * k + 1);
+        }
+
+        template <typename GoesRightT>
+        const_pointer descend(GoesRightT goes_right) const
+        {
+            const T *tree = tree_.data();
+            size_type k = 1;
+            while (k <= size_)
+            {
+                // a hint, it's fine for it to be past the end.
+                detail::prefetch(reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(tree) + uintptr_t(k) * line_keys * sizeof(T)));
+                k = 2 * k + static_cast<size_type>(goes_right(tree[k]));
+            }
+            k >>= htk::countr_zero(~k) + 1;
+            return k == 0 ? nullptr : tree + k;
+        }
+
+        htk::vector<T, htk::aligned_allocator<T>> tree_;
+        size_type size_;
+    };
+
+    /*
+        A static B-tree. Every node is one cache line of keys, B of them,
+        with B + 1 children, numbered so node k's children are
+        k * (B + 1) + 1 + i and nothing needs a pointer. A search reads one
+        line per level, log(n) / log(B + 1) of them, 7 for 100M ints where
+        a binary search takes 27.
+
+        Inside a node the search counts the keys less than x, which is
+        branchless and, for the arithmetic types this takes, a handful of
+        vector compares once the compiler is done with it.
+
+        The last node is padded with the largest T, which sorts after every
+        real key, so a search only finds padding when x is greater than all
+        of them, and that's checked up front.
+    */
+    template <typename T>
+    class s_tree_index
+    {
+        static_assert(htk::is_arithmetic_v<T>, "s_tree_index pads with numeric_limits<T>::max()");
+        static_assert(cache_line_size % sizeof(T) == 0, "keys have to tile a cache line");
+
+    public:
+        using value_type = T;
+        using size_type = htk::size_t;
+        using const_pointer = const T *;
+
+        static constexpr size_type node_keys = cache_line_size / sizeof(T);
+
+        s_tree_index()
+            : size_(0), nodes_(0)
+        {
+        }
+
+        // [first, last) has to be sorted.
+        template <typename It, typename = htk::enable_if_t<htk::is_iterator_v<It>>>
+        s_tree_index(It first, It last)
+            : size_(static_cast<size_type>(htk::distance(first, last))), nodes_((size_ + node_keys - 1) / node_keys)
+        {
+            keys_.resize(nodes_ * node_keys, std::numeric_limits<T>::max());
+            size_type placed = 0;
+            build(first, placed, 0);
+        }
+
+        template <typename ContainerT, typename = decltype(htk::declval<const ContainerT &>().cbegin())>
+        explicit s_tree_index(const ContainerT &sorted)
+            : s_tree_index(sorted.cbegin(), sorted.cend())
+        {
+        }
+
+        // the first key not less than x.
+        const_pointer lower_bound(const T &x) const
+        {
+            if (size_ == 0 || largest_ < x)
+                return nullptr;
+
+            const T *keys = keys_.data();
+            const T *found = nullptr;
+            for (size_type k = 0; k < nodes_;)
+            {
+                const T *node = keys + k * node_keys;
+                size_type less = 0;
+                for (size_type i = 0; i < node_keys; ++i)
+                    less += static_cast<size_type>(node[i] < x);
+                found = less < node_keys ? node + less : found;
+                k = child(k, less);
+            }
+            return found;
+        }
+
+        const_pointer find(const T &x) const
+        {
+            const const_pointer found = lower_bound(x);
+            return found != nullptr && *found == x ? found : nullptr;
+        }
+
+        bool contains(const T &x) const
+        {
+            return find(x) != nullptr;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+    private:
+        static size_type child(size_type node, size_type i)
+        {
+            return node * (node_keys + 1) + 1 + i;
+        }
+
+        // an in order walk again, a child before each key and one after the last.
+        template <typename It>
+        void build(It &it, size_type &placed, size_type node)
+        {
+            if (node >= nodes_)
+                return;
+            for (size_type i = 0; i < node_keys; ++i)
+            {
+                build(it, placed, child(node, i));
+                if (placed < size_)
+                {
+                    largest_ = *it;
+                    keys_.data()[node * node_keys + i] = largest_;
+                    ++it;
+                    ++placed;
+                }
+            }
+            build(it, placed, child(node, node_keys));
+        }
+
+        htk::vector<T, htk::aligned_allocator<T>> keys_;
+        size_type size_;
+        size_type nodes_;
+        T largest_ = T();
+    };
+}
+
+#endif // __htk_search_index_h__
@@ -0,0 +1,164 @@
+#ifndef __htk_small_vector_h__
+#define __htk_small_vector_h__
+
+#include <htk/memory.h>
+#include <htk/vector.h>
+
+namespace htk
+{
+    namespace detail
+    {
+        /*
+            An allocator that owns an inline buffer of N elements. Any request
+            that fits, while the buffer is free, is served from the buffer;
+            everything else goes to the inner allocator.
+
+            Because it lives inside the vector (as the vector's allocator_),
+            the buffer lives inside the vector too. That's the whole trick, the
+            vector itself doesn't need to know anything about it.
+        */
+        template <typename T, size_t N, typename AllocatorT>
+        struct small_buffer_allocator
+        {
+            using value_type = typename AllocatorT::value_type;
+            using pointer = typename AllocatorT::pointer;
+            using const_pointer = typename AllocatorT::const_pointer;
+            using reference = typename AllocatorT::reference;
+            using const_reference = typename AllocatorT::const_reference;
+            using size_type = typename AllocatorT::size_type;
+
+            small_buffer_allocator()
+                : inline_used_(false)
+            {
+            }
+
+            // the buffer is never shared, a copy gets its own.
+            small_buffer_allocator(const small_buffer_allocator &rhs)
+                : inner_(rhs.inner_), inline_used_(false)
+            {
+            }
+
+            pointer allocate(size_t count)
+            {
+                if (count <= N && !inline_used_)
+                {
+                    inline_used_ = true;
+                    return inline_data();
+                }
+                return inner_.allocate(count);
+            }
+
+            void deallocate(pointer p, size_type n)
+            {
+                if (p == inline_data())
+                {
+                    inline_used_ = false;
+                    return;
+                }
+                inner_.deallocate(p, n);
+            }
+
+            template <typename... Args>
+            void construct(reference dest, Args &&... args)
+            {
+                inner_.construct(dest, htk::forward<Args>(args)...);
+            }
+
+            void destroy(pointer p)
+            {
+                inner_.destroy(p);
+            }
+
+            size_type max_size() const
+            {
+                return inner_.max_size();
+            }
+
+            bool is_inline(const_pointer p) const
+            {
+                return p == inline_data();
+            }
+
+            pointer inline_data()
+            {
+                return reinterpret_cast<pointer>(buffer_);
+            }
+
+            const_pointer inline_data() const
+            {
+                return reinterpret_cast<const_pointer>(buffer_);
+            }
+
+        private:
+            alignas(T) unsigned char buffer_[N * sizeof(T)];
+            AllocatorT inner_;
+            bool inline_used_;
+        };
+    }
+
+    /*
+        A vector that keeps its first N elements inline, and only goes to the
+        allocator when it outgrows them.
+
+        It is an htk::vector, it just starts life with a capacity of N that
+        doesn't cost an allocation. Growth, insert and the copy/move selection
+        are all the vector's.
+    */
+    template <typename T, size_t N, typename AllocatorT = htk::allocator<T>>
+    class small_vector : public vector<T, detail::small_buffer_allocator<T, N, AllocatorT>>
+    {
+        using base = vector<T, detail::small_buffer_allocator<T, N, AllocatorT>>;
+        static_assert(N > 0, "small_vector needs at least one inline element");
+
+    public:
+        static constexpr size_t inline_capacity = N;
+        using typename base::value_type;
+        using typename base::size_type;
+        using typename base::pointer;
+
+        small_vector()
+        {
+            prime();
+        }
+
+        small_vector(const htk::initializer_list<T> &init)
+            : small_vector()
+        {
+            for (const auto &v : init)
+                base::emplace_back(v);
+        }
+
+        small_vector(const small_vector &) = delete;
+
+        small_vector(small_vector &&v)
+            : small_vector()
+        {
+            if (!v.is_inline())
+            {
+                // the other guy is on the heap, we can just take it.
+                base::allocator_.deallocate(base::data_.first, N);
+                base::data_ = v.data_;
+                v.prime();
+                return;
+            }
+            // inline storage can't be stolen, move the elements across.
+            for (auto first = v.data_.first; first != v.data_.last; ++first)
+                base::emplace_back(htk::move(*first));
+            v.clear();
+        }
+
+        bool is_inline() const
+        {
+            return base::allocator_.is_inline(base::data_.first);
+        }
+
+    private:
+        void prime()
+        {
+            const auto first = base::allocator_.allocate(N);
+            base::data_ = typename base::storage{ first, first, first + N };
+        }
+    };
+}
+
+#endif // __htk_small_vector_h__
@@ -0,0 +1,280 @@
+#ifndef __htk_soa_vector_h__
+#define __htk_soa_vector_h__
+
+#include <htk/iterator.h>
+#include <htk/memory.h>
+#include <htk/span.h>
+#include <htk/stdexcept.h>
+#include <htk/utility.h>
+#include <htk/vector.h>
+
+#include <tuple>
+#include <utility>
+
+namespace htk
+{
+    /*
+        Iterator over a soa_vector. Dereferencing gives the proxy reference,
+        a tuple of references to the item's fields, one in each column. It
+        walks the items in order, and can jump, but with the value being a
+        proxy, algorithms that swap or move items (sort, rotate) won't work
+        through it.
+    */
+    template <typename SoaVectorT>
+    class soa_iterator
+    {
+    public:
+        using iterator_category = random_access_iterator_tag;
+        using difference_type = typename SoaVectorT::difference_type;
+        using value_type = typename SoaVectorT::value_type;
+        using reference = typename SoaVectorT::reference;
+        using pointer = void;
+        using size_type = typename SoaVectorT::size_type;
+
+        soa_iterator()
+            : vec_(nullptr), index_(0)
+        {
+        }
+
+        soa_iterator(SoaVectorT *vec, size_type index)
+            : vec_(vec), index_(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*vec_)[index_];
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return (*vec_)[index_ + n];
+        }
+
+        soa_iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        soa_iterator operator++(int)
+        {
+            soa_iterator tmp{ *this };
+            ++index_;
+            return tmp;
+        }
+
+        soa_iterator &operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        soa_iterator operator--(int)
+        {
+            soa_iterator tmp{ *this };
+            --index_;
+            return tmp;
+        }
+
+        soa_iterator &operator+=(difference_type n)
+        {
+            index_ += n;
+            return *this;
+        }
+
+        soa_iterator &operator-=(difference_type n)
+        {
+            index_ -= n;
+            return *this;
+        }
+
+        soa_iterator operator+(difference_type n) const { return soa_iterator(vec_, index_ + n); }
+        soa_iterator operator-(difference_type n) const { return soa_iterator(vec_, index_ - n); }
+
+        difference_type operator-(const soa_iterator &rhs) const
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        bool operator==(const soa_iterator &rhs) const { return index_ == rhs.index_; }
+        bool operator!=(const soa_iterator &rhs) const { return index_ != rhs.index_; }
+        bool operator<(const soa_iterator &rhs) const { return index_ < rhs.index_; }
+
+    private:
+        SoaVectorT *vec_;
+        size_type index_;
+    };
+
+    /*
+        A struct of arrays. Each field is its own htk::vector, cache line
+        aligned, so a loop over one field streams through exactly that field
+        and nothing else. Trivially copyable fields get the vector's memcpy
+        paths for growth, copies and erase.
+
+            htk::soa_vector<float, float, int> particles;
+            particles.emplace_back(1.0f, 2.0f, 7);
+            for (float &x : particles.column<0>())
+                x += 1.0f;
+            for (auto [x, y, id] : particles)
+                ...
+
+        Items are handed out as a proxy, a std::tuple of references into the
+        columns, so they bind with structured bindings and write through.
+    */
+    template <typename... Fields>
+    class soa_vector
+    {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+    public:
+        template <typename F>
+        using column_type = htk::vector<F, htk::aligned_allocator<F>>;
+
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields &...>;
+        using const_reference = std::tuple<const Fields &...>;
+        using iterator = soa_iterator<soa_vector>;
+        using difference_type = htk::ptrdiff_t;
+        using size_type = htk::size_t;
+        static constexpr size_t field_count = sizeof...(Fields);
+
+        soa_vector() = default;
+
+    public: // modifiers
+        // one value per field, in order.
+        template <typename... Args>
+        reference emplace_back(Args &&... args)
+        {
+            static_assert(sizeof...(Args) == field_count, "emplace_back takes one argument per field");
+            const auto count = size();
+            try
+            {
+                emplace_columns(std::index_sequence_for<Fields...>{}, htk::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                // a column that threw leaves the others a row ahead.
+                truncate(count, std::index_sequence_for<Fields...>{});
+                throw;
+            }
+            return (*this)[count];
+        }
+
+        void push_back(const value_type &item)
+        {
+            std::apply([this](const auto &... fields) { emplace_back(fields...); }, item);
+        }
+
+        void pop_back()
+        {
+            if (empty())
+                throw htk::exception("pop_back() called on empty soa_vector");
+            truncate(size() - 1, std::index_sequence_for<Fields...>{});
+        }
+
+        void clear()
+        {
+            truncate(0, std::index_sequence_for<Fields...>{});
+        }
+
+        void reserve(size_type count)
+        {
+            std::apply([count](auto &... columns) { (columns.reserve(count), ...); }, columns_);
+        }
+
+    public: // access
+        reference operator[](size_type index)
+        {
+            return row(index, std::index_sequence_for<Fields...>{});
+        }
+
+        const_reference operator[](size_type index) const
+        {
+            return row(index, std::index_sequence_for<Fields...>{});
+        }
+
+        reference at(size_type index)
+        {
+            if (index >= size())
+                throw out_of_range("index out of range");
+            return (*this)[index];
+        }
+
+        const_reference at(size_type index) const
+        {
+            if (index >= size())
+                throw out_of_range("index out of range");
+            return (*this)[index];
+        }
+
+        // one field of every item, contiguous.
+        template <std::size_t I>
+        span<std::tuple_element_t<I, value_type>> column()
+        {
+            return span<std::tuple_element_t<I, value_type>>(std::get<I>(columns_));
+        }
+
+        template <std::size_t I>
+        span<const std::tuple_element_t<I, value_type>> column() const
+        {
+            auto &c = std::get<I>(columns_);
+            return span<const std::tuple_element_t<I, value_type>>(c.data(), static_cast<size_type>(c.size()));
+        }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, size()); }
+
+    public: // capacity
+        size_t size() const
+        {
+            return std::get<0>(columns_).size();
+        }
+
+        size_t capacity() const
+        {
+            return std::get<0>(columns_).capacity();
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+        template <std::size_t... I, typename... Args>
+        void emplace_columns(std::index_sequence<I...>, Args &&... args)
+        {
+            (std::get<I>(columns_).emplace_back(htk::forward<Args>(args)), ...);
+        }
+
+        template <std::size_t... I>
+        reference row(size_type index, std::index_sequence<I...>)
+        {
+            return reference(*(std::get<I>(columns_).data() + index)...);
+        }
+
+        template <std::size_t... I>
+        const_reference row(size_type index, std::index_sequence<I...>) const
+        {
+            return const_reference(*(std::get<I>(columns_).data() + index)...);
+        }
+
+        template <std::size_t... I>
+        void truncate(size_type count, std::index_sequence<I...>)
+        {
+            (truncate_column(std::get<I>(columns_), count), ...);
+        }
+
+        template <typename ColumnT>
+        static void truncate_column(ColumnT &column, size_type count)
+        {
+            if (column.size() > count)
+                column.erase(column.begin() + count, column.end());
+        }
+
+        std::tuple<column_type<Fields>...> columns_;
+    };
+}
+
+#endif // __htk_soa_vector_h__
@@ -0,0 +1,97 @@
+#ifndef __htk_span_h__
+#define __htk_span_h__
+
+#include <htk/exception.h>
+#include <htk/stdexcept.h>
+#include <htk/type_traits.h>
+#include <htk/types.h>
+#include <htk/utility.h>
+
+namespace htk
+{
+    /*
+        A view of count contiguous items somebody else owns. Its iterators are
+        plain pointers, so anything that takes a contiguous range gets the
+        fast path.
+    */
+    template <typename T>
+    class span
+    {
+    public:
+        using element_type = T;
+        using value_type = remove_cv_t<T>;
+        using size_type = htk::size_t;
+        using difference_type = htk::ptrdiff_t;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using const_reference = const T &;
+        using iterator = T *;
+
+        span()
+            : data_(nullptr), size_(0)
+        {
+        }
+
+        span(pointer data, size_type size)
+            : data_(data), size_(size)
+        {
+        }
+
+        // anything with data() and size().
+        template <typename ContainerT, typename = decltype(htk::declval<ContainerT &>().data())>
+        span(ContainerT &container)
+            : data_(container.data()), size_(static_cast<size_type>(container.size()))
+        {
+        }
+
+        iterator begin() const { return data_; }
+        iterator end() const { return data_ + size_; }
+
+        reference operator[](size_type index) const
+        {
+            return data_[index];
+        }
+
+        reference at(size_type index) const
+        {
+            if (index >= size_)
+                throw out_of_range("index out of range");
+            return data_[index];
+        }
+
+        reference front() const { return data_[0]; }
+        reference back() const { return data_[size_ - 1]; }
+
+        pointer data() const noexcept { return data_; }
+        size_type size() const noexcept { return size_; }
+        size_type size_bytes() const noexcept { return size_ * sizeof(T); }
+        bool empty() const noexcept { return size_ == 0; }
+
+        span subspan(size_type offset, size_type count) const
+        {
+            // offset + count could wrap.
+            if (offset > size_ || count > size_ - offset)
+                throw out_of_range("subspan out of range");
+            return span(data_ + offset, count);
+        }
+
+        span first(size_type count) const
+        {
+            return subspan(0, count);
+        }
+
+        span last(size_type count) const
+        {
+            if (count > size_)
+                throw out_of_range("subspan out of range");
+            return subspan(size_ - count, count);
+        }
+
+    private:
+        pointer data_;
+        size_type size_;
+    };
+}
+
+#endif // __htk_span_h__
@@ -0,0 +1,355 @@
+#ifndef __htk_stable_vector_h__
+#define __htk_stable_vector_h__
+
+#include <htk/bit.h>
+#include <htk/exception.h>
+#include <htk/initializer_list.h>
+#include <htk/iterator.h>
+#include <htk/memory.h>
+#include <htk/stdexcept.h>
+#include <htk/utility.h>
+
+namespace htk
+{
+    namespace detail
+    {
+        /*
+            The segment layout shared by stable_vector and concurrent_vector.
+            Segment k holds SegmentSize << k items, so the ones before it hold
+            SegmentSize * (2^k - 1), and an index splits into a segment and an
+            offset with a bit_width and two subtractions.
+        */
+        template <size_t SegmentSize>
+        struct geometric_segments
+        {
+            static_assert((SegmentSize & (SegmentSize - 1)) == 0, "SegmentSize must be a power of two");
+
+            // one per bit of size_t, less whatever SegmentSize already covers.
+            static constexpr size_t max_segments = sizeof(size_t) * 8 - 1 - detail::log2(SegmentSize);
+
+            struct position
+            {
+                size_t segment;
+                size_t offset;
+            };
+
+            static size_t segment_capacity(size_t segment)
+            {
+                return SegmentSize << segment;
+            }
+
+            // the items that fit in the first `segments` segments.
+            static size_t capacity(size_t segments)
+            {
+                return SegmentSize * ((size_t(1) << segments) - 1);
+            }
+
+            static position split(size_t index)
+            {
+                const auto segment = static_cast<size_t>(htk::bit_width(index / SegmentSize + 1) - 1);
+                return position{ segment, index - capacity(segment) };
+            }
+        };
+    }
+
+    /*
+        Random access iterator for the segmented vectors. It's the container
+        and an index, every dereference goes through the directory.
+    */
+    template <typename StableVectorT>
+    class stable_vector_iterator
+    {
+    public:
+        using iterator_category = random_access_iterator_tag;
+        using difference_type = typename StableVectorT::difference_type;
+        using value_type = typename StableVectorT::value_type;
+        using pointer = typename StableVectorT::pointer;
+        using reference = typename StableVectorT::reference;
+        using size_type = typename StableVectorT::size_type;
+
+        stable_vector_iterator()
+            : vec_(nullptr), index_(0)
+        {
+        }
+
+        stable_vector_iterator(const StableVectorT *vec, size_type index)
+            : vec_(vec), index_(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *vec_->locate(index_);
+        }
+
+        pointer operator->() const
+        {
+            return vec_->locate(index_);
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return *vec_->locate(index_ + n);
+        }
+
+        stable_vector_iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        stable_vector_iterator operator++(int)
+        {
+            stable_vector_iterator tmp{ *this };
+            ++index_;
+            return tmp;
+        }
+
+        stable_vector_iterator &operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        stable_vector_iterator operator--(int)
+        {
+            stable_vector_iterator tmp{ *this };
+            --index_;
+            return tmp;
+        }
+
+        stable_vector_iterator &operator+=(difference_type n)
+        {
+            index_ += n;
+            return *this;
+        }
+
+        stable_vector_iterator &operator-=(difference_type n)
+        {
+            index_ -= n;
+            return *this;
+        }
+
+        stable_vector_iterator operator+(difference_type n) const
+        {
+            return stable_vector_iterator(vec_, index_ + n);
+        }
+
+        stable_vector_iterator operator-(difference_type n) const
+        {
+            return stable_vector_iterator(vec_, index_ - n);
+        }
+
+        difference_type operator-(const stable_vector_iterator &rhs) const
+        {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        bool operator==(const stable_vector_iterator &rhs) const { return index_ == rhs.index_; }
+        bool operator!=(const stable_vector_iterator &rhs) const { return index_ != rhs.index_; }
+        bool operator<(const stable_vector_iterator &rhs) const { return index_ < rhs.index_; }
+        bool operator>(const stable_vector_iterator &rhs) const { return index_ > rhs.index_; }
+        bool operator<=(const stable_vector_iterator &rhs) const { return index_ <= rhs.index_; }
+        bool operator>=(const stable_vector_iterator &rhs) const { return index_ >= rhs.index_; }
+
+        size_type index() const { return index_; }
+
+    private:
+        const StableVectorT *vec_;
+        size_type index_;
+    };
+
+    template <typename StableVectorT>
+    stable_vector_iterator<StableVectorT> operator+(typename stable_vector_iterator<StableVectorT>::difference_type n,
+                                                   const stable_vector_iterator<StableVectorT> &it)
+    {
+        return it + n;
+    }
+
+    /*
+        A vector that never moves what it holds. Items live in segments, the
+        first of SegmentSize items and each one after twice the last, so
+        growing is allocating the next segment and nothing else: no copy, no
+        spike, and a pointer to an item is good until that item is erased.
+
+        The segment directory is a fixed array, a segment per bit of the size
+        type, so finding an item is a bit_width and two subtractions:
+
+            segment = bit_width(i / SegmentSize + 1) - 1
+            offset  = i - SegmentSize * (2^segment - 1)
+
+        Storage isn't contiguous, so there's no data(), and iterators go
+        through the directory on each dereference.
+    */
+    template <typename T, typename AllocatorT = htk::allocator<T>, size_t SegmentSize = 16>
+    class stable_vector
+    {
+        using layout = detail::geometric_segments<SegmentSize>;
+
+        template <typename>
+        friend class stable_vector_iterator;
+
+    public:
+        using value_type = T;
+        using reference = T &;
+        using const_reference = const T &;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using iterator = stable_vector_iterator<stable_vector>;
+        using const_iterator = const iterator;
+        using difference_type = htk::ptrdiff_t;
+        using size_type = htk::size_t;
+        using allocator_type = AllocatorT;
+
+        static constexpr size_t segment_size = SegmentSize;
+        static constexpr size_t max_segments = layout::max_segments;
+
+        stable_vector()
+            : size_(0), segments_(0), directory_{}
+        {
+        }
+
+        explicit stable_vector(const AllocatorT &allocator)
+            : size_(0), segments_(0), directory_{}, allocator_(allocator)
+        {
+        }
+
+        stable_vector(const htk::initializer_list<T> &init)
+            : stable_vector()
+        {
+            for (const auto &item : init)
+                emplace_back(item);
+        }
+
+        stable_vector(const stable_vector &) = delete;
+        stable_vector &operator=(const stable_vector &) = delete;
+
+        ~stable_vector() noexcept
+        {
+            clear();
+            for (size_type s = 0; s < segments_; ++s)
+                allocator_.deallocate(directory_[s], layout::segment_capacity(s));
+        }
+
+    public: // modifiers
+        template <typename... Args>
+        T &emplace_back(Args &&... args)
+        {
+            const auto [segment, offset] = layout::split(size_);
+            if (segment == segments_)
+                add_segment();
+            const pointer p = directory_[segment] + offset;
+            allocator_.construct(*p, htk::forward<Args>(args)...);
+            ++size_;
+            return *p;
+        }
+
+        void push_back(const T &item)
+        {
+            emplace_back(item);
+        }
+
+        void push_back(T &&item)
+        {
+            emplace_back(htk::move(item));
+        }
+
+        void pop_back()
+        {
+            if (empty())
+                throw htk::exception("pop_back() called on empty stable_vector");
+            allocator_.destroy(locate(--size_));
+        }
+
+        // destroys everything, the segments are kept for reuse.
+        void clear()
+        {
+            while (size_ != 0)
+                allocator_.destroy(locate(--size_));
+        }
+
+    public: // access
+        T &at(size_type index)
+        {
+            if (index >= size_)
+                throw out_of_range("index out of range");
+            return *locate(index);
+        }
+
+        const T &at(size_type index) const
+        {
+            if (index >= size_)
+                throw out_of_range("index out of range");
+            return *locate(index);
+        }
+
+        T &back()
+        {
+            if (empty())
+                throw htk::exception("back() called on empty stable_vector");
+            return *locate(size_ - 1);
+        }
+
+        const T &back() const
+        {
+            if (empty())
+                throw htk::exception("back() called on empty stable_vector");
+            return *locate(size_ - 1);
+        }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, size_); }
+        const_iterator cbegin() const { return iterator(this, 0); }
+        const_iterator cend() const { return iterator(this, size_); }
+
+    public: // capacity
+        // allocates segments until count items fit. nothing moves.
+        void reserve(size_type count)
+        {
+            while (capacity() < count)
+                add_segment();
+        }
+
+        size_t capacity() const noexcept
+        {
+            return layout::capacity(segments_);
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        size_t segments() const
+        {
+            return segments_;
+        }
+
+    private:
+        pointer locate(size_type index) const
+        {
+            const auto [segment, offset] = layout::split(index);
+            return directory_[segment] + offset;
+        }
+
+        void add_segment()
+        {
+            if (segments_ == max_segments)
+                throw bad_alloc("stable_vector is out of segments");
+            directory_[segments_] = allocator_.allocate(layout::segment_capacity(segments_));
+            ++segments_;
+        }
+
+        size_type size_;
+        size_type segments_;
+        pointer directory_[max_segments];
+        AllocatorT allocator_;
+    };
+}
+
+#endif // __htk_stable_vector_h__
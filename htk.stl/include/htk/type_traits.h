@@ -33,6 +33,15 @@ namespace htk
     template <typename ...Args>
     using int_t = int;
 
+    template <typename T, typename U>
+    struct is_same : false_type {};
+
+    template <typename T>
+    struct is_same<T, T> : true_type {};
+
+    template <typename T, typename U>
+    constexpr bool is_same_v = is_same<T, U>::value;
+
     template <typename T>
     struct remove_reference
     {
@@ -104,12 +113,35 @@ namespace htk
     template <typename T>
     constexpr bool is_trivially_constructible_v = is_trivially_constructible<T>::value;
 
+    template <typename T>
+    struct is_empty : bool_constant<__is_empty(T)> {};
+
+    template <typename T>
+    constexpr bool is_empty_v = is_empty<T>::value;
+
     template <typename T>
     struct is_trivial : bool_constant<is_trivially_copyable_v<T> && is_trivially_constructible_v<T>>{};
 
     template <typename T>
     constexpr bool is_trivial_v = is_trivial<T>::value;
 
+    /*
+        A type is trivially relocatable when moving it somewhere else and
+        forgetting the original is the same as copying its bytes. That's
+        anything trivially copyable, but also most types that just own a
+        pointer, which can't say so on their own. Those opt in:
+
+            template <>
+            struct htk::is_trivially_relocatable<my_type> : htk::true_type {};
+
+        Containers then move them with a memcpy and never destroy the source.
+    */
+    template <typename T>
+    struct is_trivially_relocatable : bool_constant<is_trivially_copyable_v<T>> {};
+
+    template <typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
     template<typename T, typename ...Args>
     struct is_constructible : bool_constant<__is_constructible(T, Args...)> {};
 
@@ -119,6 +151,50 @@ namespace htk
     template <typename T>
     constexpr bool is_move_constructible_v = is_move_constructible<T>::value;
 
+    template <typename T>
+    struct is_integral_base : false_type {};
+
+    template <> struct is_integral_base<bool> : true_type {};
+    template <> struct is_integral_base<char> : true_type {};
+    template <> struct is_integral_base<signed char> : true_type {};
+    template <> struct is_integral_base<unsigned char> : true_type {};
+    template <> struct is_integral_base<wchar_t> : true_type {};
+    template <> struct is_integral_base<char16_t> : true_type {};
+    template <> struct is_integral_base<char32_t> : true_type {};
+    template <> struct is_integral_base<short> : true_type {};
+    template <> struct is_integral_base<unsigned short> : true_type {};
+    template <> struct is_integral_base<int> : true_type {};
+    template <> struct is_integral_base<unsigned int> : true_type {};
+    template <> struct is_integral_base<long> : true_type {};
+    template <> struct is_integral_base<unsigned long> : true_type {};
+    template <> struct is_integral_base<long long> : true_type {};
+    template <> struct is_integral_base<unsigned long long> : true_type {};
+
+    template <typename T>
+    struct is_integral : is_integral_base<remove_cv_t<T>> {};
+
+    template <typename T>
+    constexpr bool is_integral_v = is_integral<T>::value;
+
+    template <typename T>
+    struct is_floating_point_base : false_type {};
+
+    template <> struct is_floating_point_base<float> : true_type {};
+    template <> struct is_floating_point_base<double> : true_type {};
+    template <> struct is_floating_point_base<long double> : true_type {};
+
+    template <typename T>
+    struct is_floating_point : is_floating_point_base<remove_cv_t<T>> {};
+
+    template <typename T>
+    constexpr bool is_floating_point_v = is_floating_point<T>::value;
+
+    template <typename T>
+    struct is_arithmetic : bool_constant<is_integral_v<T> || is_floating_point_v<T>> {};
+
+    template <typename T>
+    constexpr bool is_arithmetic_v = is_arithmetic<T>::value;
+
     template <typename T>
     struct is_pointer : htk::false_type {};
 
@@ -128,6 +204,15 @@ namespace htk
     template <typename T>
     constexpr bool is_pointer_v = is_pointer<T>::value;
 
+    template <typename T>
+    struct is_lvalue_reference : htk::false_type {};
+
+    template <typename T>
+    struct is_lvalue_reference<T&> : htk::true_type {};
+
+    template <typename T>
+    constexpr bool is_lvalue_reference_v = is_lvalue_reference<T>::value;
+
     template <typename T = void>
     struct is_void : false_type {};
 
@@ -5,12 +5,12 @@
 
 namespace htk
 {
-    size_t min(size_t a, size_t b)
+    inline size_t min(size_t a, size_t b)
     {
         return a < b ? a : b;
     }
 
-    size_t max(size_t a, size_t b)
+    inline size_t max(size_t a, size_t b)
     {
         return a > b ? a : b;
     }
@@ -33,6 +33,10 @@ namespace htk
         return static_cast<remove_reference_t<T>&&>(t);
     }
     
+    // only for use in unevaluated contexts, there's no definition.
+    template <typename T>
+    T &&declval() noexcept;
+
     template<bool B, typename T, typename F>
     struct conditional 
     { 
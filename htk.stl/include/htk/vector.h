@@ -1,6 +1,7 @@
 #ifndef __htk_vector_h__
 #define __htk_vector_h__
 
+#include <htk/algorithm.h>
 #include <htk/exception.h>
 #include <htk/initializer_list.h>
 #include <htk/iterator.h>
@@ -8,13 +9,32 @@
 #include <htk/stdexcept.h>
 #include <htk/utility.h>
 
+#include <algorithm>
 #include <vector>
 
-
+/*
+    HTK_ITERATOR_CHECKS selects which iterator htk::vector hands out.
+
+    1 - the checked vector_iterator, which carries a back pointer to the
+        vector and validates every dereference, seek and comparison.
+    0 - vector_unchecked_iterator, which is nothing but a pointer. This is
+        what lets the optimizer treat a loop over a vector the same as a
+        loop over a raw array.
+
+    Defaults to checked for _DEBUG builds, unchecked otherwise. Define it
+    before including this header to override.
+*/
+#ifndef HTK_ITERATOR_CHECKS
+#ifdef _DEBUG
+#define HTK_ITERATOR_CHECKS 1
+#else
+#define HTK_ITERATOR_CHECKS 0
+#endif
+#endif
 
 namespace htk
 {
-    void assert_(bool cond, const char *msg)
+    inline void assert_(bool cond, const char *msg)
     {
         if (!cond)
             throw invalid_operation(msg);
@@ -91,7 +111,7 @@ namespace htk
         {
             assert_(ptr_ != nullptr, "empty iterator");
             const auto next = ptr_ + val;
-            assert_(next < vec_->data_.last && next >= vec_->data_.first, "seek out of bounds");
+            assert_(next <= vec_->data_.last && next >= vec_->data_.first, "seek out of bounds");
             ptr_ += val;
             return *this;
         }
@@ -120,8 +140,8 @@ namespace htk
         vector_iterator operator-=(const difference_type val)
         {
             assert_(ptr_ != nullptr, "empty iterator");
-            const auto next = ptr_ + val;
-            assert_(next < vec_->data_.last && next >= vec_->data_.first, "seek out of bounds");
+            const auto next = ptr_ - val;
+            assert_(next <= vec_->data_.last && next >= vec_->data_.first, "seek out of bounds");
             ptr_ -= val;
             return *this;
         }
@@ -164,6 +184,218 @@ namespace htk
         return r.ptr() - l.ptr();
     }
 
+    /*
+        The release flavour of the vector iterator. It's the same shape as
+        vector_iterator, minus the back pointer and the checks, so it's
+        the size of a pointer and every operation is a single pointer op.
+    */
+    template <typename VectorT>
+    class vector_unchecked_iterator
+    {
+    public:
+        using iterator_category = random_access_iterator_tag;
+        using container = const VectorT;
+        using difference_type = typename container::difference_type;
+        using value_type = typename container::value_type;
+        using pointer = typename container::pointer;
+        using reference = typename container::reference;
+
+        vector_unchecked_iterator()
+            : ptr_(nullptr)
+        {
+        }
+
+        explicit vector_unchecked_iterator(pointer ptr)
+            : ptr_(ptr)
+        {
+        }
+
+        vector_unchecked_iterator(pointer ptr, container *)
+            : ptr_(ptr)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *ptr_;
+        }
+
+        pointer operator->() const
+        {
+            return ptr_;
+        }
+
+        reference operator[](const difference_type val) const
+        {
+            return ptr_[val];
+        }
+
+        vector_unchecked_iterator &operator++()
+        {
+            ++ptr_;
+            return *this;
+        }
+
+        vector_unchecked_iterator operator++(int)
+        {
+            vector_unchecked_iterator tmp{ *this };
+            ++ptr_;
+            return tmp;
+        }
+
+        vector_unchecked_iterator &operator--()
+        {
+            --ptr_;
+            return *this;
+        }
+
+        vector_unchecked_iterator operator--(int)
+        {
+            vector_unchecked_iterator tmp{ *this };
+            --ptr_;
+            return tmp;
+        }
+
+        vector_unchecked_iterator &operator+=(const difference_type val)
+        {
+            ptr_ += val;
+            return *this;
+        }
+
+        vector_unchecked_iterator &operator-=(const difference_type val)
+        {
+            ptr_ -= val;
+            return *this;
+        }
+
+        vector_unchecked_iterator operator+(const difference_type val) const
+        {
+            return vector_unchecked_iterator(ptr_ + val);
+        }
+
+        vector_unchecked_iterator operator-(const difference_type val) const
+        {
+            return vector_unchecked_iterator(ptr_ - val);
+        }
+
+        bool operator==(const vector_unchecked_iterator &rhs) const { return ptr_ == rhs.ptr_; }
+        bool operator!=(const vector_unchecked_iterator &rhs) const { return ptr_ != rhs.ptr_; }
+        bool operator<(const vector_unchecked_iterator &rhs) const { return ptr_ < rhs.ptr_; }
+        bool operator>(const vector_unchecked_iterator &rhs) const { return ptr_ > rhs.ptr_; }
+        bool operator<=(const vector_unchecked_iterator &rhs) const { return ptr_ <= rhs.ptr_; }
+        bool operator>=(const vector_unchecked_iterator &rhs) const { return ptr_ >= rhs.ptr_; }
+
+        const pointer &ptr() const { return ptr_; }
+        pointer &ptr() { return ptr_; }
+
+    private:
+        pointer ptr_;
+    };
+
+    template <typename VectorT>
+    typename vector_unchecked_iterator<VectorT>::difference_type operator-(const vector_unchecked_iterator<VectorT> &r, const vector_unchecked_iterator<VectorT> &l)
+    {
+        return static_cast<typename vector_unchecked_iterator<VectorT>::difference_type>(r.ptr() - l.ptr());
+    }
+
+    template <typename VectorT>
+    vector_unchecked_iterator<VectorT> operator+(typename vector_unchecked_iterator<VectorT>::difference_type val, const vector_unchecked_iterator<VectorT> &it)
+    {
+        return it + val;
+    }
+
+    template <typename VectorT>
+    struct is_contiguous_iterator<vector_iterator<VectorT>> : true_type
+    {
+    };
+
+    template <typename VectorT>
+    struct is_contiguous_iterator<vector_unchecked_iterator<VectorT>> : true_type
+    {
+    };
+
+    namespace detail
+    {
+        template <typename VectorT>
+        typename VectorT::pointer undress(const vector_iterator<VectorT> &it)
+        {
+            return it.ptr();
+        }
+
+        template <typename VectorT>
+        typename VectorT::pointer undress(const vector_unchecked_iterator<VectorT> &it)
+        {
+            return it.ptr();
+        }
+    }
+
+    /*
+        Growth policies. A policy decides the capacity the vector starts with,
+        and the capacity it moves to once `required` elements no longer fit
+        in `capacity`.
+
+        double_growth       - 2x, what the vector has always done.
+        one_and_half_growth - 1.5x, trades more reallocations for less slack.
+        page_growth         - 1.5x, rounded up to whole pages. Meant for big
+                              buffers, where the allocator hands out pages
+                              anyway and realloc can remap them.
+        exact_growth        - exactly what's required, no slack at all.
+    */
+    template <size_t Initial = 10>
+    struct double_growth
+    {
+        static constexpr size_t initial_capacity = Initial;
+
+        static size_t next(size_t capacity, size_t required, size_t)
+        {
+            if (capacity == 0)
+                capacity = htk::max(Initial, 1);
+            while (capacity < required)
+                capacity = capacity * 2;
+            return capacity;
+        }
+    };
+
+    template <size_t Initial = 10>
+    struct one_and_half_growth
+    {
+        static constexpr size_t initial_capacity = Initial;
+
+        static size_t next(size_t capacity, size_t required, size_t)
+        {
+            if (capacity < 2)
+                capacity = htk::max(Initial, 2);
+            while (capacity < required)
+                capacity = capacity + capacity / 2;
+            return capacity;
+        }
+    };
+
+    template <size_t Initial = 10, size_t PageSize = 4096>
+    struct page_growth
+    {
+        static constexpr size_t initial_capacity = Initial;
+
+        static size_t next(size_t capacity, size_t required, size_t element_size)
+        {
+            const size_t wanted = htk::max(required, one_and_half_growth<Initial>::next(capacity, required, element_size));
+            const auto bytes = static_cast<unsigned long long>(wanted) * element_size;
+            const auto pages = (bytes + PageSize - 1) / PageSize;
+            return static_cast<size_t>((pages * PageSize) / element_size);
+        }
+    };
+
+    template <size_t Initial = 10>
+    struct exact_growth
+    {
+        static constexpr size_t initial_capacity = Initial;
+
+        static size_t next(size_t, size_t required, size_t)
+        {
+            return required;
+        }
+    };
+
     /*
         We're going to implement a simple vector, that uses a simple allocator,
         and implments all public members of the vector on CPP reference.
@@ -173,25 +405,31 @@ namespace htk
     */
 
 
-    template <typename T, typename AllocatorT = htk::allocator<T>>
+    template <typename T, typename AllocatorT = htk::allocator<T>, typename GrowthT = htk::double_growth<>>
     class vector
     {
-        friend vector_iterator;
+        template <typename>
+        friend class vector_iterator;
         /// member types
     public:
-        static constexpr size_t initial_capacity = 10;
+        static constexpr size_t initial_capacity = GrowthT::initial_capacity;
         using value_type = T;
         using reference = typename AllocatorT::reference;
         using const_reference = typename AllocatorT::const_reference;
-        using iterator = vector_iterator<vector<T>>;
-        using const_iterator = const vector_iterator<vector<T>>;
+        using checked_iterator = vector_iterator<vector>;
+        using unchecked_iterator = vector_unchecked_iterator<vector>;
+        using iterator = typename htk::conditional<HTK_ITERATOR_CHECKS, checked_iterator, unchecked_iterator>::type;
+        using const_iterator = const iterator;
         using difference_type = htk::ptrdiff_t;
         using size_type = htk::size_t;
         using allocator_type = AllocatorT;
         using pointer = typename AllocatorT::pointer;
         using const_pointer = typename AllocatorT::const_pointer;
+        using growth_policy = GrowthT;
 
     private:
+        using allocator_traits = htk::allocator_traits<AllocatorT>;
+
         struct move_items_tag
         {
         };
@@ -202,11 +440,19 @@ namespace htk
         {
         };
 
-        using copy_type = typename htk::conditional<htk::is_trivial_v<T>, memcpy_items_tag,
+        // relocatable types are moved with a memmove, and the source is
+        // just forgotten, it's never destroyed.
+        static constexpr bool relocates = htk::is_trivially_relocatable_v<T>;
+
+        using copy_type = typename htk::conditional<relocates, memcpy_items_tag,
             typename htk::conditional<htk::is_move_constructible_v<T>, move_items_tag, copy_items_tag>::type>::type;
 
-    private:
-        struct data
+        // relocatable types can be handed to the allocator's reallocate, which may
+        // extend the block where it is instead of allocate, copy and free.
+        static constexpr bool grows_in_place = relocates && htk::allocator_can_reallocate_v<AllocatorT>;
+
+    protected:
+        struct storage
         {
             pointer first;
             pointer last;
@@ -228,7 +474,7 @@ namespace htk
             }
         };
 
-        data data_;
+        storage data_;
         AllocatorT allocator_;
 
 
@@ -246,17 +492,90 @@ namespace htk
             insert(end(), init.begin(), init.end());
         }
 
-        vector(const vector &v) = delete;
+        explicit vector(const AllocatorT &allocator)
+            : data_{ nullptr, nullptr, nullptr }, allocator_(allocator)
+        {
+        }
+
+        // one allocation of exactly size(), and a memcpy when T allows.
+        vector(const vector &v)
+            : data_{ nullptr, nullptr, nullptr },
+              allocator_(allocator_traits::select_on_container_copy_construction(v.allocator_))
+        {
+            if (v.empty())
+                return;
+            const auto count = v.size();
+            const pointer first = allocator_.allocate(count);
+            try
+            {
+                copy_items(v.data_.first, v.data_.last, first);
+            }
+            catch (...)
+            {
+                allocator_.deallocate(first, count);
+                throw;
+            }
+            data_ = storage{ first, first + count, first + count };
+        }
+
         vector(vector &&v)
-            : data_{ nullptr, nullptr, nullptr }
+            : data_{ nullptr, nullptr, nullptr }, allocator_(htk::move(v.allocator_))
         {
             std::swap(data_, v.data_);
         }
 
         ~vector() noexcept
         {
-            destroy(data_.first, data_.last);
-            allocator_.deallocate(data_.first, data_.capacity());
+            free_storage();
+        }
+
+        vector &operator=(const vector &rhs)
+        {
+            if (this == &rhs)
+                return *this;
+            if constexpr (allocator_traits::propagate_on_container_copy_assignment::value)
+            {
+                // our buffer came from our allocator, it can't outlive it.
+                if (!allocator_traits::equal(allocator_, rhs.allocator_))
+                    free_storage();
+                allocator_ = rhs.allocator_;
+            }
+            assign_items(rhs.data_.first, rhs.data_.last);
+            return *this;
+        }
+
+        vector &operator=(vector &&rhs) noexcept(allocator_traits::propagate_on_container_move_assignment::value ||
+                                                 allocator_traits::is_always_equal::value)
+        {
+            if (this == &rhs)
+                return *this;
+            if constexpr (allocator_traits::propagate_on_container_move_assignment::value)
+            {
+                free_storage();
+                allocator_ = htk::move(rhs.allocator_);
+                take_storage(rhs);
+            }
+            else
+            {
+                if (allocator_traits::equal(allocator_, rhs.allocator_))
+                {
+                    free_storage();
+                    take_storage(rhs);
+                    return *this;
+                }
+                // our allocator can't free their buffer, so the items move
+                // across instead of the buffer.
+                clear();
+                reserve(rhs.size());
+                pointer dest = data_.first;
+                move_items(rhs.data_.first, rhs.data_.last, dest, copy_type{});
+                data_.last = dest;
+                if constexpr (relocates)
+                    rhs.data_.last = rhs.data_.first;
+                else
+                    rhs.clear();
+            }
+            return *this;
         }
 
     public: // modifiers
@@ -269,10 +588,14 @@ namespace htk
         }
 
         template <typename... Args>
-        decltype(auto) emplace(const_iterator where, Args &&... args)
+        iterator emplace(const_iterator where, Args &&... args)
         {
-            const T value{ htk::forward(args)... };
-            return insert(where, 1, htk::forward(args));
+            // built before the shift, the args could be referring to one of ours.
+            T value(htk::forward<Args>(args)...);
+            const auto offset = static_cast<size_type>(where.ptr() - data_.first);
+            const pointer gap = make_gap(offset, 1);
+            fill_gap(gap, 1, [&](pointer p) { allocator_.construct(*p, htk::move(value)); });
+            return iterator(gap, this);
         }
 
         void push_back(const T &item)
@@ -287,174 +610,35 @@ namespace htk
 
         iterator insert(const_iterator where, size_type count, const T &value)
         {
-            // if we're not at the end; and the count is larger than what's there
-            // we need to grow
-            const auto offset = where.ptr() - data_.first;
-            pointer whereptr = data_.first + offset;
-            if (where != end() && freespace() < count)
-            {
-                // we're going to reallocate
-                const auto cap = calculate_growth(count);
-                const auto curs = size();
-                auto first = allocator_.allocate(cap);
-
-                auto last = first + curs + count;
-                const auto end = first + cap;
-
-                data next = { first, last, end };
-                // we're going to copy
-
-                try
-                {
-                    move_items(data_.first, data_.first + offset, next.first, copy_type{});
-                    auto dest = first;
-                    for (size_type i = 0; i < count; ++i, dest++)
-                    {
-                        allocator_.construct(*(dest), value);
-                    }
-                    move_items(data_.first + offset, data_.last, dest, copy_type{});
-                }
-                catch (...)
-                {
-                    allocator_.deallocate(next.first, next.capacity());
-                }
-
-                const auto old = data_;
-                data_ = next;
-
-                destroy(old.first, old.last);
-                allocator_.deallocate(old.first, old.capacity());
-                // we're going to create
-            }
-            // else we have enough space
-            else if (where != end())
-            {
-                // we just shift the guys down by copying backwards...,
-                // and create in place
-                auto dest = data_.last + count - 1;
-                if constexpr (htk::is_trivial_v<T>)
-                {
-                    // we can memmove the whole block, not worrying about overlap.
-                    const auto first = data_.first + offset;
-                    const auto last = data_.last;
-                    const auto mdest = data_.first + offset + count;
-                    memmove(mdest, first, (last - first) * sizeof(T));
-                }
-                else
-                {
-                    const auto el2move = static_cast<size_type>(data_.last - where.ptr());
-                    if (count > el2move) // I'm inserting more than elements to move, move it all
-                    {
-                        move_items(whereptr, data_.last, data_.last, copy_type{});
-                        // destroy anything we moved.
-                        destroy(whereptr, data_.last);
-                    }
-                    else
-                    {
-                        // move only tail items, and copy backwards the overlap
-                        auto target = data_.last;
-                        move_items(data_.last - count, data_.last, target, copy_type{});
-                        copy_backward(whereptr, data_.last - count, data_.last, copy_type{});
-                    }
-                }
-                // move the end pointer
-                data_.last += count;
-                assign_value(whereptr, whereptr + count, value);
-            }
-            else
-            {
-                // insert into the end.
-                for (size_type i = 0; i < count; ++i)
-                {
-                    allocator_.construct(*(data_.last++), value);
-                }
-            }
-            return vector_iterator(data_.first + offset, this);
+            // the value could be one of ours, which the shift is about to move.
+            const T copy{ value };
+            const auto offset = static_cast<size_type>(where.ptr() - data_.first);
+            const pointer gap = make_gap(offset, count);
+            fill_gap(gap, count, [&](pointer p) { allocator_.construct(*p, copy); });
+            return iterator(data_.first + offset, this);
         }
 
+        // The source iterators must not point into this vector.
         template <typename It, typename = htk::enable_if_t<htk::is_iterator_v<It>>>
         iterator insert(const_iterator where, It start, It fin)
         {
+            const auto offset = static_cast<size_type>(where.ptr() - data_.first);
+            insert_range(offset, start, fin, htk::iterator_category_t<It>{});
+            return iterator(data_.first + offset, this);
+        }
 
-            // if we're not at the end; and the count is larger than what's there
-            // we need to grow
-            const auto count = fin - start;
-            const auto offset = where.ptr() - data_.first;
-            const pointer whereptr = data_.first + offset;
-            if (freespace() < count)
-            {
-                // we're going to reallocate
-                const auto cap = calculate_growth(count);
-                const auto curs = size();
-                auto first = allocator_.allocate(cap);
-
-                auto last = first + curs + count;
-                const auto end = first + cap;
-
-                data next = { first, last, end };
-                // we're going to copy
-
-                try
-                {
-                    move_items(data_.first, data_.first + offset, next.first, copy_type{});
-                    auto dest = first + offset;
-                    while (start != fin)
-                        allocator_.construct(*(dest++), *(start++));
-                    move_items(data_.first + offset, data_.last, dest, copy_type{});
-                }
-                catch (...)
-                {
-                    allocator_.deallocate(next.first, next.capacity());
-                }
-
-                const auto old = data_;
-                data_ = next;
+        iterator insert(const_iterator where, const htk::initializer_list<T> &init)
+        {
+            return insert(where, init.begin(), init.end());
+        }
 
-                destroy(old.first, old.last);
-                allocator_.deallocate(old.first, old.capacity());
-            }
-            // else we have enough space
-            else if (where != end())
-            {
-                // we just shift the guys down by copying backwards...,
-                // and create in place
-                auto dest = data_.last + count - 1;
-                if constexpr (htk::is_trivial_v<T>)
-                {
-                    // we can memmove the whole block, not worrying about overlap.
-                    const auto first = data_.first + offset;
-                    const auto last = data_.last;
-                    const auto mdest = data_.first + offset + count;
-                    memmove(mdest, first, (last - first) * sizeof(T));
-                }
-                else
-                {
-                    const auto el2move = static_cast<size_type>(data_.last - whereptr);
-                    if (count > el2move) // I'm inserting more than elements to move, move it all
-                    {
-                        move_items(whereptr, data_.last, data_.last, copy_type{});
-                        // destroy anything we moved.
-                        destroy(whereptr, data_.last);
-                    }
-                    else
-                    {
-                        // move only tail items, and copy backwards the overlap
-                        auto target = data_.last;
-                        move_items(data_.last - count, data_.last, target, copy_type{});
-                        copy_backward(whereptr, data_.last - count, data_.last, copy_type{});
-                    }
-                }
-                // move the end pointer
-                data_.last += count;
-                assign_values(whereptr, start, fin);
-            }
-            else
-            {
-                // insert into the end.
-                assign_values(data_.last, start, fin);
-                data_.last += count;
-            }
-            return vector_iterator(data_.first + offset, this);
+        // anything with begin() and end(), appended in one go.
+        template <typename RangeT>
+        void append_range(RangeT &&range)
+        {
+            auto first = range.begin();
+            auto last = range.end();
+            insert_range(size(), first, last, htk::iterator_category_t<decltype(first)>{});
         }
 
         void clear()
@@ -468,12 +652,67 @@ namespace htk
             data_.last = data_.first;
         }
 
+        iterator erase(const_iterator where)
+        {
+            return erase_items(where.ptr(), where.ptr() + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            return erase_items(first.ptr(), last.ptr());
+        }
+
         void pop_back()
         {
             allocator_.destroy(data_.last - 1);
             data_.last--;
         }
 
+        void resize(size_type count)
+        {
+            if (count <= size())
+            {
+                truncate(data_.first + count);
+                return;
+            }
+            const pointer last = make_room_for(count);
+            create(last, data_.first + count);
+            data_.last = data_.first + count;
+        }
+
+        void resize(size_type count, const T &value)
+        {
+            if (count <= size())
+            {
+                truncate(data_.first + count);
+                return;
+            }
+            const T copy{ value };
+            const pointer last = make_room_for(count);
+            create(last, data_.first + count, copy);
+            data_.last = data_.first + count;
+        }
+
+        // Like resize, but new items are default-initialized rather than
+        // value-initialized. For trivial types that means they're left as
+        // whatever was in memory; nothing touches them. It's for sizing a
+        // buffer that something else (a read, a decoder) is about to fill.
+        void resize_default_init(size_type count)
+        {
+            if (count <= size())
+            {
+                truncate(data_.first + count);
+                return;
+            }
+            const pointer last = make_room_for(count);
+            if constexpr (!htk::is_trivially_constructible_v<T>)
+            {
+                for (auto first = last; first != data_.first + count; ++first)
+                    ::new (static_cast<void *>(first)) T;
+            }
+            data_.last = data_.first + count;
+        }
+
     public:
         T &back()
         {
@@ -507,6 +746,21 @@ namespace htk
             return *(data_.first + index);
         }
 
+        T *data() noexcept
+        {
+            return data_.first;
+        }
+
+        const T *data() const noexcept
+        {
+            return data_.first;
+        }
+
+        allocator_type get_allocator() const
+        {
+            return allocator_;
+        }
+
     public:
         const_iterator cbegin() const
         {
@@ -534,6 +788,33 @@ namespace htk
             return data_.freespace();
         }
 
+        void reserve(size_type count)
+        {
+            if (count <= capacity())
+                return;
+            if (data_.end_of_container == nullptr)
+            {
+                data_.first = allocator_.allocate(count);
+                data_.last = data_.first;
+                data_.end_of_container = data_.first + count;
+                return;
+            }
+            grow(count);
+        }
+
+        void shrink_to_fit()
+        {
+            if (freespace() == 0)
+                return;
+            if (empty())
+            {
+                allocator_.deallocate(data_.first, capacity());
+                data_ = storage{ nullptr, nullptr, nullptr };
+                return;
+            }
+            grow(size());
+        }
+
         size_t capacity() const noexcept
         {
             return data_.capacity();
@@ -576,13 +857,175 @@ namespace htk
             // we good.
         }
 
+        /*
+            The range insert. Forward ranges are counted first so there's
+            exactly one gap made, and so at most one reallocation. Input
+            ranges can only be walked once, so they're appended one at a time
+            with the usual growth, and rotated into place if they weren't
+            going on the end.
+        */
+        template <typename It>
+        void insert_range(size_type offset, It start, It fin, htk::input_iterator_tag)
+        {
+            const auto old_size = size();
+            for (; start != fin; ++start)
+                emplace_back(*start);
+            if (offset != old_size)
+                std::rotate(data_.first + offset, data_.first + old_size, data_.last);
+        }
+
+        template <typename It>
+        void insert_range(size_type offset, It start, It fin, htk::forward_iterator_tag)
+        {
+            const auto count = static_cast<size_type>(htk::distance(start, fin));
+            const pointer gap = make_gap(offset, count);
+            if constexpr (copies_as_bytes<It>())
+            {
+                if (count != 0)
+                    memcpy(gap, htk::detail::undress(start), count * sizeof(T));
+                data_.last += count;
+            }
+            else
+            {
+                fill_gap(gap, count, [&](pointer p) { allocator_.construct(*p, *start); ++start; });
+            }
+        }
+
+        // a contiguous run of the same trivially copyable type is one memcpy.
+        template <typename It>
+        static constexpr bool copies_as_bytes()
+        {
+            return htk::is_contiguous_iterator_v<It> && htk::is_trivially_copyable_v<T> &&
+                   htk::is_same_v<htk::remove_cv_t<typename htk::iterator_traits<It>::value_type>, T>;
+        }
+
+        // copies [first, last) into raw memory at dest. if a copy throws,
+        // whatever was built is destroyed again.
+        void copy_items(const_pointer first, const_pointer last, pointer dest)
+        {
+            if constexpr (htk::is_trivially_copyable_v<T>)
+            {
+                if (first != last)
+                    memcpy(dest, first, (last - first) * sizeof(T));
+            }
+            else
+            {
+                pointer built = dest;
+                try
+                {
+                    for (; first != last; ++first, ++built)
+                        allocator_.construct(*built, *first);
+                }
+                catch (...)
+                {
+                    destroy(dest, built);
+                    throw;
+                }
+            }
+        }
+
+        // makes this a copy of [first, last), reusing the buffer if it fits.
+        void assign_items(const_pointer first, const_pointer last)
+        {
+            const auto count = static_cast<size_type>(last - first);
+            if (count > capacity())
+            {
+                // build the copy first, so a throw leaves us as we were.
+                const pointer fresh = allocator_.allocate(count);
+                try
+                {
+                    copy_items(first, last, fresh);
+                }
+                catch (...)
+                {
+                    allocator_.deallocate(fresh, count);
+                    throw;
+                }
+                free_storage();
+                data_ = storage{ fresh, fresh + count, fresh + count };
+                return;
+            }
+
+            if constexpr (htk::is_trivially_copyable_v<T>)
+            {
+                if (count != 0)
+                    memcpy(data_.first, first, count * sizeof(T));
+                data_.last = data_.first + count;
+            }
+            else
+            {
+                // assign over what's there, then build or trim the rest.
+                const pointer overlap = data_.first + htk::min(count, size());
+                pointer dest = data_.first;
+                for (; dest != overlap; ++dest, ++first)
+                    *dest = *first;
+                if (dest == data_.last)
+                {
+                    copy_items(first, last, data_.last);
+                    data_.last = data_.first + count;
+                }
+                else
+                {
+                    truncate(dest);
+                }
+            }
+        }
+
+        // destroys everything and hands the buffer back.
+        void free_storage()
+        {
+            destroy(data_.first, data_.last);
+            if (data_.first != nullptr)
+                allocator_.deallocate(data_.first, data_.capacity());
+            data_ = storage{ nullptr, nullptr, nullptr };
+        }
+
+        void take_storage(vector &rhs)
+        {
+            data_ = rhs.data_;
+            rhs.data_ = storage{ nullptr, nullptr, nullptr };
+        }
+
+        // closes [first, last) by pulling the tail down over it.
+        iterator erase_items(pointer first, pointer last)
+        {
+            if (first == last)
+                return iterator(first, this);
+
+            if constexpr (relocates)
+            {
+                destroy(first, last);
+                memmove(static_cast<void *>(first), static_cast<const void *>(last), (data_.last - last) * sizeof(T));
+                data_.last -= (last - first);
+            }
+            else
+            {
+                pointer dest = first;
+                for (pointer src = last; src != data_.last; ++src, ++dest)
+                    *dest = htk::move(*src);
+                truncate(dest);
+            }
+            return iterator(first, this);
+        }
+
+        // makes sure there's room for count items in total, returns last.
+        pointer make_room_for(size_type count)
+        {
+            if (count > capacity())
+                ensure_space_at_least(count - size());
+            return data_.last;
+        }
+
+        // destroys everything from new_last on.
+        void truncate(pointer new_last)
+        {
+            destroy(new_last, data_.last);
+            data_.last = new_last;
+        }
+
         size_type calculate_growth(size_type count)
         {
-            auto cap = capacity();
-            auto curs = size();
-            while (cap - curs < count)
-                cap = cap * 2;
-            return cap;
+            return static_cast<size_type>(GrowthT::next(capacity(), size() + count, sizeof(T)));
         }
 
         void check_bounds(const_iterator where)
@@ -593,6 +1036,17 @@ namespace htk
 
         void grow(size_type cap)
         {
+            if constexpr (grows_in_place)
+            {
+                // realloc either extends the block, remaps it, or does the
+                // allocate, copy and free itself. Any of which beats doing it
+                // by hand, which holds both buffers for the whole copy.
+                const auto curs = size();
+                const pointer new_vec = allocator_.reallocate(data_.first, capacity(), cap);
+                data_ = storage{ new_vec, new_vec + curs, new_vec + cap };
+                return;
+            }
+
             pointer new_vec = allocator_.allocate(cap);
             pointer dest = new_vec;
             try
@@ -601,9 +1055,6 @@ namespace htk
             }
             catch (...)
             {
-
-                // this is wrong. we really need to be keeping track of what was
-                // initialized.
                 destroy(new_vec, dest);
                 allocator_.deallocate(new_vec, cap);
                 throw;
@@ -611,62 +1062,174 @@ namespace htk
 
             auto old = data_;
             auto curs = size();
-            data_ = data{ new_vec, new_vec + curs, new_vec + cap };
+            data_ = storage{ new_vec, new_vec + curs, new_vec + cap };
 
-            // destroy the old stuff
-            destroy(old.first, old.last);
-            allocator_.deallocate(old.first, old.capacity());
+            release(old);
         }
 
-        // we have to test if it's move constructable
-        void move_items(pointer first, pointer last, pointer &dest, move_items_tag)
+        // Opens `count` uninitialized slots at offset, growing if there isn't
+        // room. Everything from offset on moves up past last, which doesn't
+        // include the gap yet: the caller fills it with fill_gap, or bumps
+        // last itself once it's built something that can't throw.
+        pointer make_gap(size_type offset, size_type count)
         {
-            while (first != last)
-                allocator_.construct(*(dest++), htk::move(*(first++)));
-        }
+            if (count == 0)
+                return data_.first + offset;
 
-        void move_items(pointer first, pointer last, pointer &dest, memcpy_items_tag)
-        {
-            memmove(dest, first, (last - first) * sizeof(T));
+            if (data_.end_of_container == nullptr || (grows_in_place && freespace() < count))
+                ensure_space_at_least(count);
+
+            if (freespace() < count)
+                return regrow_with_gap(offset, count);
+
+            const pointer where = data_.first + offset;
+            shift_up(where, count);
+            return where;
         }
 
-        void move_items(pointer first, pointer last, pointer &dest, copy_items_tag)
+        // builds the gap one slot at a time with make(slot). If one throws,
+        // what was built is destroyed and the tail moves back down, leaving
+        // the vector as it was before make_gap.
+        template <typename MakeT>
+        void fill_gap(pointer gap, size_type count, MakeT make)
         {
-            while (first != last)
-                allocator_.construct(*(dest++), *(first++));
+            pointer dest = gap;
+            try
+            {
+                for (; dest != gap + count; ++dest)
+                    make(dest);
+            }
+            catch (...)
+            {
+                destroy(gap, dest);
+                close_gap(gap, count);
+                throw;
+            }
+            data_.last += count;
         }
 
-        void copy_backward(pointer first, pointer last, pointer dest, move_items_tag)
+        // the undo of shift_up, for an empty gap of count slots at where.
+        void close_gap(pointer where, size_type count)
         {
-            while (first != last)
+            if constexpr (relocates)
             {
-                const auto target = last--;
-                *(dest--) = htk::move(*target);
+                memmove(static_cast<void *>(where), static_cast<const void *>(where + count), (data_.last - where) * sizeof(T));
+            }
+            else
+            {
+                const pointer live = where + count;
+                const pointer top = data_.last + count;
+                pointer src = live;
+                pointer dest = where;
+                // the bottom of the tail lands in the gap, which is raw memory.
+                while (src != top && dest != live)
+                    construct_from(dest++, src++, copy_type{});
+                // the rest lands on live objects.
+                while (src != top)
+                    *(dest++) = htk::move(*(src++));
+                destroy(live < data_.last ? data_.last : live, top);
             }
         }
 
-        void copy_backward(pointer first, pointer last, pointer dest, copy_items_tag)
+        // moves [where, last) up by count, into memory we know is there.
+        void shift_up(pointer where, size_type count)
         {
-            while (first != last)
+            if constexpr (relocates)
             {
-                const auto target = last--;
-                *(dest--) = *target;
+                memmove(static_cast<void *>(where + count), static_cast<const void *>(where), (data_.last - where) * sizeof(T));
+            }
+            else
+            {
+                pointer src = data_.last;
+                pointer dest = data_.last + count;
+                // the top of the tail lands past last, in raw memory.
+                while (src != where && dest != data_.last)
+                {
+                    --src;
+                    --dest;
+                    construct_from(dest, src, copy_type{});
+                }
+                // the rest lands on live objects.
+                while (src != where)
+                {
+                    --src;
+                    --dest;
+                    *dest = htk::move(*src);
+                }
+                // whatever is left in the gap was moved from, the caller will
+                // construct over it.
+                destroy(where, where + htk::min(count, static_cast<size_type>(data_.last - where)));
             }
         }
 
-        template <typename It>
-        void assign_values(pointer dest, It begin, It end)
+        // reallocates with a gap of count slots at offset, in one pass.
+        pointer regrow_with_gap(size_type offset, size_type count)
         {
-            while (begin != end)
+            const auto cap = calculate_growth(count);
+            const auto curs = size();
+            const pointer first = allocator_.allocate(cap);
+            pointer head = first;
+            pointer tail = first + offset + count;
+            try
             {
-                *(dest++) = *(begin++);
+                move_items(data_.first, data_.first + offset, head, copy_type{});
+                move_items(data_.first + offset, data_.last, tail, copy_type{});
             }
+            catch (...)
+            {
+                if constexpr (!relocates)
+                {
+                    destroy(first, head);
+                    destroy(first + offset + count, tail);
+                }
+                allocator_.deallocate(first, cap);
+                throw;
+            }
+
+            // last leaves out the gap, same as shift_up.
+            const auto old = data_;
+            data_ = storage{ first, first + curs, first + cap };
+            release(old);
+            return first + offset;
         }
 
-        void assign_value(pointer first, pointer last, const T &value)
+        // frees a buffer whose items have been moved out.
+        void release(const storage &old)
         {
-            while (first != last)
-                *(first++) = value;
+            if constexpr (!relocates)
+                destroy(old.first, old.last);
+            allocator_.deallocate(old.first, old.capacity());
+        }
+
+        // we have to test if it's move constructable
+        void move_items(pointer first, pointer last, pointer &dest, move_items_tag)
+        {
+            // dest only moves past an item once it's built, so an unwind
+            // knows what to destroy.
+            for (; first != last; ++first, ++dest)
+                allocator_.construct(*dest, htk::move(*first));
+        }
+
+        void move_items(pointer first, pointer last, pointer &dest, memcpy_items_tag)
+        {
+            memmove(static_cast<void *>(dest), static_cast<const void *>(first), (last - first) * sizeof(T));
+            dest += last - first;
+        }
+
+        void construct_from(pointer dest, pointer src, move_items_tag)
+        {
+            allocator_.construct(*dest, htk::move(*src));
+        }
+
+        void construct_from(pointer dest, pointer src, copy_items_tag)
+        {
+            allocator_.construct(*dest, *src);
+        }
+
+        void move_items(pointer first, pointer last, pointer &dest, copy_items_tag)
+        {
+            for (; first != last; ++first, ++dest)
+                allocator_.construct(*dest, *first);
         }
 
         template <typename... Args>
@@ -683,7 +1246,21 @@ namespace htk
         }
     };
 
+    // erases everything pred accepts, in one pass. returns how many went.
+    template <typename T, typename AllocatorT, typename GrowthT, typename PredT>
+    typename vector<T, AllocatorT, GrowthT>::size_type erase_if(vector<T, AllocatorT, GrowthT> &v, PredT pred)
+    {
+        const auto size = v.size();
+        const auto last = htk::remove_if(v.begin(), v.end(), pred);
+        v.erase(last, v.end());
+        return size - v.size();
+    }
 
+    template <typename T, typename AllocatorT, typename GrowthT, typename ValueT>
+    typename vector<T, AllocatorT, GrowthT>::size_type erase(vector<T, AllocatorT, GrowthT> &v, const ValueT &value)
+    {
+        return htk::erase_if(v, [&value](const T &item) { return item == value; });
+    }
 }
 
 #endif // __htk_vector_h__
\ No newline at end of file